@@ -3,8 +3,6 @@
 ///---------------------------------------------------------
 /// AnimBase
 
-sf::Vector2f AnimBase::s_local;
-
 ///---------------------------------------------------------
 AnimBase::AnimBase(float start_time) : m_time_last(start_time),
                                        m_color(sf::Color::Transparent) {
@@ -20,6 +18,10 @@ void AnimBase::Draw(sf::RenderWindow & window) {
   window.draw(m_sprite);
 }
 
+void AnimBase::Capture(DrawList& list) const {
+  list.Add(m_sprite);
+}
+
 ///---------------------------------------------------------
 void AnimBase::setSprite(const std::string & name) {
   m_sprite = SpriteManager::Get(name);
@@ -52,7 +54,7 @@ void AnimBase::setOrientation(float angle) {
 
 ///---------------------------------------------------------
 void AnimBase::setPosition(sf::Vector2f pos) {
-  m_sprite.setPosition({ pos.x + s_local.x, pos.y + s_local.y });
+  m_sprite.setPosition(pos);
 }
 
 ///---------------------------------------------------------
@@ -97,6 +99,16 @@ catch (...) {
   terminate();
 }
 
+///---------------------------------------------------------
+void AnimSingle::Restart(float time_start) {
+  m_time_last = time_start;
+  m_current_frame = -1;
+  f_stop = false;
+  sf::IntRect rec = m_sprite.getTextureRect();
+  rec.left = m_info->origin_pos.x;
+  m_sprite.setTextureRect(rec);
+}
+
 ///---------------------------------------------------------
 void AnimSingle::Update(float time) {
   AnimBase::UpdateBlink(time);
@@ -257,6 +269,12 @@ void AnimList::Draw(sf::RenderWindow & window) {
   }
 }
 
+void AnimList::Capture(DrawList& list) const {
+  for (auto& item : m_list) {
+    item->Capture(list);
+  }
+}
+
 ///---------------------------------------------------------
 void AnimList::setPosition(sf::Vector2f pos) {
   for (auto& item : m_list) {
@@ -407,7 +425,7 @@ void test_animate_queue() {
   using namespace  sf;
   using namespace  std;
 
-    SharedContext(R"(..\resources\paths.cfg)");
+    SharedContext("../resources/paths.cfg");
 
     SpriteSheetInfo::LoadSpriteSheetInfo(SharedContext::getFilePath("SpriteSheet"));
 
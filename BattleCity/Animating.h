@@ -19,6 +19,7 @@
 
 #include "SpriteManager.h"
 #include "SupportTools.h"
+#include "DrawList.h"
 
 /// \brief  содержит параметры описывающие правила воспроизведения анимации.   
 ///     
@@ -76,7 +77,8 @@ std::ostream& operator<<(std::ostream& os, const SpriteSheetInfo& trg);
 /// 
 /// \pre  перед использованием экземпляров, нужно выполнить 
 ///     SpriteSheetInfo::LoadSpriteSheetInfo.
-///     Позиция вводится относительно установленной локальной системы отсчета \a s_local.
+///     Позиция вводится в координатах игрового поля, смещение поля в окне задается
+///     видом окна при отображении (BattleSnapshot::Draw).
 /// \warning  -т.к. инициализация не предоставляет sf::Drawable объекта, его не 
 ///       забыть перед использованием. 
 /// \see AnimList
@@ -88,10 +90,11 @@ class AnimBase {
   virtual bool IsCompleted() { return false; }    ///< флаг завершения для нецикличных анимаций 
 
   void Draw(sf::RenderWindow& window);
+  void Capture(DrawList& list) const;             ///< \see DrawList
   void setSprite(const std::string& name);
   void setSpriteSheet(const std::string& name);
   void setOrientation(float angle);               ///< угол в град, по часовой стрелке
-  void setPosition(sf::Vector2f pos);             ///< \param pos точка в локальной системе
+  void setPosition(sf::Vector2f pos);             ///< \param pos точка на игровом поле
 
   /// \brief  устанавливает мерцание изображения
   /// \param  period  период 
@@ -101,9 +104,6 @@ class AnimBase {
   /// \brief  возвращает имя хранимой анимации (или спрайта)
   const std::string& getName() const { return m_name; }
 
-  /// \brief  локальная система отсчета позиций (только смещенная от системы окна)
-  static sf::Vector2f s_local;
-
  protected:
   void UpdateBlink(float time);
 
@@ -133,6 +133,10 @@ class AnimSingle : public AnimBase {
   void Update(float time) override;
   virtual bool IsCompleted() { return f_stop; }
 
+  /// \brief проигрывает анимацию заново с первого кадра (повторное использование экземпляра)
+  /// \param  time_start  глобальное время старта
+  void Restart(float time_start);
+
  private:
   using AnimBase::setSprite;
   int m_current_frame = -1;
@@ -183,6 +187,7 @@ class AnimList {
   using element = std::unique_ptr<AnimBase>;
   void Update(float time);
   void Draw(sf::RenderWindow&);
+  void Capture(DrawList&) const;
   void Clear() { m_list.clear(); }            ///< очищает набор
 
   void setPosition(sf::Vector2f);
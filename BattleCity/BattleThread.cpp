@@ -0,0 +1,57 @@
+#include "BattleThread.h"
+
+#include <chrono>
+
+BattleThread::BattleThread(BattleCity& battle, sf::Time tick) : m_battle(battle), m_tick(tick) {
+}
+
+
+void BattleThread::Start() {
+  if (m_running) return;
+  // начальное состояние доступно отображению до первого шага
+  Publish();
+  m_running = true;
+  m_thread = std::thread(&BattleThread::Run, this);
+}
+
+
+void BattleThread::Stop() {
+  m_running = false;
+  if (m_thread.joinable()) m_thread.join();
+}
+
+
+void BattleThread::Run() {
+  using Clock = std::chrono::steady_clock;
+  const Clock::duration tick = std::chrono::microseconds(m_tick.asMicroseconds());
+  // наибольшее отставание от реального времени, больший разрыв пропускается
+  const Clock::duration max_lag = tick * 5;
+  Clock::time_point deadline = Clock::now();
+  while (m_running && !m_battle.getInfo().geme_over_flag) {
+    ApplyCommands();
+    m_battle.Update(m_tick);
+    Publish();
+
+    deadline += tick;
+    Clock::time_point now = Clock::now();
+    // после долгого шага сроки отсчитываются заново, а не догоняются пачкой шагов
+    if (now - deadline > max_lag) deadline = now;
+    std::this_thread::sleep_until(deadline);
+  }
+}
+
+
+void BattleThread::ApplyCommands() {
+  unsigned commands = m_commands.exchange(0, std::memory_order_relaxed);
+  if (commands & UP)    m_battle.Player_up();
+  if (commands & DOWN)  m_battle.Player_down();
+  if (commands & LEFT)  m_battle.Player_left();
+  if (commands & RIGHT) m_battle.Player_right();
+  if (commands & FIRE)  m_battle.Player_fire();
+}
+
+
+void BattleThread::Publish() {
+  m_battle.Capture(m_buffer.Write(), m_tick);
+  m_buffer.Publish();
+}
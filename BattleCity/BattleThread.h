@@ -0,0 +1,68 @@
+/// \file
+/// \ingroup battle_city_game_classes
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#include <SFML/System.hpp>
+
+#include "GameBattleCity.h"
+#include "TripleBuffer.h"
+
+
+/// \brief Моделирует битву в отдельном потоке, публикуя состояние после каждого шага
+///
+/// Поток выполняет шаги BattleCity::Update постоянной длительности по реальному времени
+/// и после каждого шага записывает BattleSnapshot в TripleBuffer. Поток отображения
+/// забирает последнее состояние (Acquire) без блокировок, поэтому тяжелые шаги обработки
+/// взаимодействий не задерживают кадры, а медленные кадры - шаги моделирования.
+///
+/// Команды управления игрока накапливаются атомарной маской (Push) и применяются
+/// потоком моделирования в начале шага: к BattleCity обращается только он.
+/// На время работы потока (Start - Stop) экземпляр BattleCity нельзя использовать
+/// из других потоков. После завершения игры шаги прекращаются, последнее состояние
+/// остается опубликованным.
+/// \see State_Battle
+class BattleThread {
+ public:
+  /// команды управления игрока
+  enum Command : unsigned {
+    UP    = 1 << 0,
+    DOWN  = 1 << 1,
+    LEFT  = 1 << 2,
+    RIGHT = 1 << 3,
+    FIRE  = 1 << 4
+  };
+
+  /// \param battle запущенная битва (BattleCity::Start)
+  /// \param tick длительность шага моделирования (как в Game)
+  explicit BattleThread(BattleCity& battle, sf::Time tick = sf::seconds(1.0f / 60));
+  BattleThread(const BattleThread&) = delete;
+  BattleThread& operator=(const BattleThread&) = delete;
+  ~BattleThread() { Stop(); }
+
+  void Start();                         ///< запускает поток моделирования
+  void Stop();                          ///< останавливает поток, дожидаясь окончания шага
+
+  /// передает команду управления игрока в следующий шаг
+  void Push(Command command) { m_commands.fetch_or(command, std::memory_order_relaxed); }
+
+  /// последнее опубликованное состояние (только поток отображения)
+  BattleSnapshot& Acquire() {
+    m_buffer.Acquire();
+    return m_buffer.Read();
+  }
+
+ private:
+  void Run();
+  void ApplyCommands();
+  void Publish();
+
+  BattleCity&                   m_battle;
+  sf::Time                      m_tick;
+  TripleBuffer<BattleSnapshot>  m_buffer;
+  std::atomic<unsigned>         m_commands{ 0 };
+  std::atomic<bool>             m_running{ false };
+  std::thread                   m_thread;
+};
@@ -0,0 +1,128 @@
+/// \file
+/// \ingroup battle_city_game_classes
+#pragma once
+
+#include <vector>
+#include <limits>
+
+#include <SFML\Graphics.hpp>
+
+#include "Components.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define BATTLE_CITY_SSE
+#include <xmmintrin.h>
+#endif
+
+
+/// \ingroup interaction_processing_algorithms
+/// \brief Проверяет область \a rec на пересечение с блоком из 4 областей (структура массивов).
+/// Условие пересечения совпадает с sf::Rect::intersects для областей положительного размера.
+/// \return битовая маска: бит i установлен, если пересекается i-я область блока
+inline unsigned IntersectMask4(const float* left, const float* top,
+                               const float* right, const float* bottom,
+                               const sf::FloatRect& rec) {
+#ifdef BATTLE_CITY_SSE
+  __m128 l = _mm_set1_ps(rec.left);
+  __m128 t = _mm_set1_ps(rec.top);
+  __m128 r = _mm_set1_ps(rec.left + rec.width);
+  __m128 b = _mm_set1_ps(rec.top + rec.height);
+  __m128 hit = _mm_and_ps(
+    _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(left), r), _mm_cmplt_ps(l, _mm_loadu_ps(right))),
+    _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(top), b), _mm_cmplt_ps(t, _mm_loadu_ps(bottom))));
+  return static_cast<unsigned>(_mm_movemask_ps(hit));
+#else
+  float r = rec.left + rec.width;
+  float b = rec.top + rec.height;
+  unsigned mask = 0;
+  for (unsigned i = 0; i < 4; ++i) {
+    if (left[i] < r && rec.left < right[i] && top[i] < b && rec.top < bottom[i]) {
+      mask |= 1u << i;
+    }
+  }
+  return mask;
+#endif
+}
+
+
+/// \ingroup interaction_processing_algorithms
+/// \brief Области всех экземпляров типа на текущем шаге в виде структуры массивов
+/// \tparam T тип игровой сущности, хранящий позицию и размер в ComponentTable
+///
+/// Заполняется один раз за шаг (Fill) по массивам ComponentTable, после чего области
+/// не пересчитываются через виртуальный getSize() для каждой пары.
+/// Массивы дополняются до кратного 4 размера пустыми областями, которые
+/// ни с чем не пересекаются, поэтому проверка идет целыми блоками (IntersectMask4).
+/// Кроме областей отбора (getBounds) сохраняются области экземпляров (getExactBounds):
+/// вместе они передаются узкой проверке пар (NarrowBounds, EntityManager::NarrowPhase)
+/// вместо обращения к экземплярам.
+/// \warning кэш отражает положение на момент заполнения, смещения юнитов
+///   в ходе взаимодействий в нем не учитываются
+/// \see EntityManager::Interaction
+template <typename T>
+class BoundsCache {
+ public:
+  /// \brief записывает области всех строк таблицы в порядке строк.
+  /// Читает только массивы позиций и размеров, без обращения к экземплярам.
+  /// Область строки (ComponentTable::getMotionBounds) совпадает с BroadBounds экземпляра.
+  /// Строки экземпляров, созданных на текущем шаге (staged), и уничтоженных,
+  /// но еще не удаленных из хранилища (isDestroyed), пропускаются.
+  void Fill(const ComponentTable<T>& table) {
+    m_items.clear();
+    m_left.clear(); m_top.clear(); m_right.clear(); m_bottom.clear();
+    m_rects.clear();
+    m_exact.clear();
+    for (unsigned row = 0; row < table.getRowsNum(); ++row) {
+      if (table.staged[row] || table.entity[row]->isDestroyed()) continue;
+      sf::FloatRect rec = table.getMotionBounds(row);
+      m_items.push_back(table.entity[row]);
+      m_left.push_back(rec.left);
+      m_top.push_back(rec.top);
+      m_right.push_back(rec.left + rec.width);
+      m_bottom.push_back(rec.top + rec.height);
+      m_rects.push_back(rec);
+      m_exact.push_back(table.getBounds(row));
+    }
+    Pad();
+  }
+
+  /// вызывает Operation(T&, unsigned id) для каждого элемента, пересекающегося с областью,
+  /// в порядке заполнения
+  template <typename Operation>
+  void Query(const sf::FloatRect& rec, Operation op) {
+    for (std::size_t base = 0; base < m_left.size(); base += 4) {
+      unsigned mask = IntersectMask4(&m_left[base], &m_top[base],
+                                     &m_right[base], &m_bottom[base], rec);
+      for (unsigned i = 0; mask; ++i, mask >>= 1) {
+        if (mask & 1) op(*m_items[base + i], static_cast<unsigned>(base + i));
+      }
+    }
+  }
+
+  /// сохраненная область элемента (BroadBounds на момент заполнения)
+  const sf::FloatRect& getBounds(unsigned id) const { return m_rects[id]; }
+
+  /// сохраненная область экземпляра (совпадает с GameEntity::getBounds на момент заполнения)
+  const sf::FloatRect& getExactBounds(unsigned id) const { return m_exact[id]; }
+
+  T& operator[](unsigned id) { return *m_items[id]; }
+  std::size_t size() const { return m_items.size(); }
+
+ private:
+  /// дополняет массивы до кратного 4 размера пустыми областями
+  void Pad() {
+    const float inf = std::numeric_limits<float>::max();
+    while (m_left.size() % 4) {
+      m_left.push_back(inf);  m_right.push_back(-inf);
+      m_top.push_back(inf);   m_bottom.push_back(-inf);
+    }
+  }
+
+  std::vector<T*>     m_items;
+  std::vector<float>  m_left;
+  std::vector<float>  m_top;
+  std::vector<float>  m_right;
+  std::vector<float>  m_bottom;
+  std::vector<sf::FloatRect> m_rects;           ///< области отбора, без дополнения
+  std::vector<sf::FloatRect> m_exact;           ///< области экземпляров, без дополнения
+};
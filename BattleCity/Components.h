@@ -0,0 +1,250 @@
+/// \file
+/// \ingroup battle_city_game_classes
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <cmath>
+
+#include <SFML\Graphics.hpp>
+
+
+/// направления, доступные для юнитов
+// явно продублирован знаковый тип значений,
+// угол [0 .. 180, 0 ..-180], знак + от оси X к Y
+enum direction : int {
+  FORWD = -90,
+  RIGHT = 0,
+  BACK = 90,
+  LEFT = 180
+};
+
+/// состояние отображения
+enum state {
+  BIRTH = 1,  ///< появление
+  ACTIVE = 2, ///< действие
+  DESTRUC = 3 ///< уничтожение
+};
+
+/// сторона, к которой относится юнит
+enum class Faction : std::uint8_t {
+  NEUTRAL = 0,    ///< препятствия, бонусы
+  PLAYER = 1,     ///< игрок и его снаряды
+  ENEMY = 2       ///< противники и их снаряды
+};
+
+
+template <typename T> class ComponentRow;
+
+/// \brief Часто используемые данные всех экземпляров типа в виде структуры массивов
+/// \tparam T тип игровой сущности
+///
+/// Позиция, размер, направление, состояние, сторона и владелец экземпляров хранятся
+/// в отдельных плотных массивах, а не в самих объектах, где рядом лежат анимации,
+/// стратегии поведения и команды. Проходы отбора пар (BoundsCache::Fill) и перемещения
+/// (EntityManager::IntegratePass) читают только нужные массивы, не затрагивая
+/// остальные данные объектов.
+///
+/// Строка выделяется при создании экземпляра (ComponentRow) и освобождается при его
+/// удалении. Строки экземпляров, созданных на текущем шаге, отмечены staged
+/// до применения отложенных команд (EntityRegistry::Flush). При удалении
+/// на место удаленной строки переносится последняя, поэтому массивы
+/// остаются плотными. Кроме удаления, порядок строк меняется только
+/// перестановкой строк (SwapRows) при упорядочивании по позициям (MortonOrder).
+/// Таблица принадлежит хранилищу типа своего мира (Factory::getTable).
+/// \see ComponentRow, BoundsCache
+template <typename T>
+class ComponentTable {
+ public:
+  std::vector<sf::Vector2f> pos;          ///< координаты на игровом поле
+  std::vector<sf::Vector2f> pos_last;     ///< позиция до последнего перемещения
+  std::vector<sf::Vector2f> pos_tick;     ///< позиция в начале шага моделирования (SaveTickPositions)
+  std::vector<sf::Vector2f> size;         ///< размер прямоугольной области
+  std::vector<direction>    dir;          ///< направление движения
+  std::vector<std::uint8_t> moving;       ///< перемещение задано на текущем шаге (ComponentRow::Move)
+  std::vector<float>        step;         ///< длина перемещения вдоль dir на текущем шаге
+  std::vector<state>        status;       ///< состояние отображения
+  std::vector<Faction>      faction;      ///< сторона
+  std::vector<int>          owner;        ///< номер создавшего юнита (-1 - нет)
+  std::vector<std::uint8_t> staged;       ///< экземпляр создан на текущем шаге и еще не включен
+  std::vector<T*>           entity;       ///< экземпляр строки
+
+  ComponentTable() = default;
+  ComponentTable(const ComponentTable&) = delete;
+  ComponentTable& operator=(const ComponentTable&) = delete;
+
+  std::size_t getRowsNum() const { return entity.size(); }
+
+  /// выделяет память массивов для \a count строк
+  void reserve(std::size_t count) {
+    pos.reserve(count);
+    pos_last.reserve(count);
+    pos_tick.reserve(count);
+    size.reserve(count);
+    dir.reserve(count);
+    moving.reserve(count);
+    step.reserve(count);
+    status.reserve(count);
+    faction.reserve(count);
+    owner.reserve(count);
+    staged.reserve(count);
+    entity.reserve(count);
+    rows.reserve(count);
+  }
+
+  /// меняет местами строки \a a и \a b (номера строк экземпляров обновляются)
+  void SwapRows(unsigned a, unsigned b) {
+    if (a == b) return;
+    std::swap(pos[a], pos[b]);
+    std::swap(pos_last[a], pos_last[b]);
+    std::swap(pos_tick[a], pos_tick[b]);
+    std::swap(size[a], size[b]);
+    std::swap(dir[a], dir[b]);
+    std::swap(moving[a], moving[b]);
+    std::swap(step[a], step[b]);
+    std::swap(status[a], status[b]);
+    std::swap(faction[a], faction[b]);
+    std::swap(owner[a], owner[b]);
+    std::swap(staged[a], staged[b]);
+    std::swap(entity[a], entity[b]);
+    std::swap(rows[a], rows[b]);
+    rows[a]->m_index = a;
+    rows[b]->m_index = b;
+  }
+
+  /// \brief запоминает позиции всех строк в начале шага моделирования.
+  /// Отображение интерполирует между ними и текущими позициями (EntityManager::Capture)
+  void SaveTickPositions() { pos_tick = pos; }
+
+  /// область экземпляра строки \a row
+  sf::FloatRect getBounds(unsigned row) const {
+    return { pos[row].x - size[row].x / 2, pos[row].y - size[row].y / 2,
+             size[row].x, size[row].y };
+  }
+
+  /// область, покрывающая прошлую и текущую позиции (для неподвижных совпадает с getBounds)
+  sf::FloatRect getMotionBounds(unsigned row) const {
+    const sf::Vector2f& p = pos[row];
+    const sf::Vector2f& q = pos_last[row];
+    const sf::Vector2f& s = size[row];
+    return { std::min(p.x, q.x) - s.x / 2, std::min(p.y, q.y) - s.y / 2,
+             s.x + std::abs(p.x - q.x), s.y + std::abs(p.y - q.y) };
+  }
+
+ private:
+  friend class ComponentRow<T>;
+
+  unsigned Insert(T* item, ComponentRow<T>* row) {
+    pos.emplace_back();
+    pos_last.emplace_back();
+    pos_tick.emplace_back();
+    size.emplace_back();
+    dir.push_back(FORWD);
+    moving.push_back(0);
+    step.push_back(0);
+    status.push_back(ACTIVE);
+    faction.push_back(Faction::NEUTRAL);
+    owner.push_back(-1);
+    staged.push_back(1);
+    entity.push_back(item);
+    rows.push_back(row);
+    return static_cast<unsigned>(entity.size() - 1);
+  }
+
+  /// удаляет строку, перенося на ее место последнюю
+  void Erase(unsigned index) {
+    std::size_t last = entity.size() - 1;
+    if (index != last) {
+      pos[index] = pos[last];
+      pos_last[index] = pos_last[last];
+      pos_tick[index] = pos_tick[last];
+      size[index] = size[last];
+      dir[index] = dir[last];
+      moving[index] = moving[last];
+      step[index] = step[last];
+      status[index] = status[last];
+      faction[index] = faction[last];
+      owner[index] = owner[last];
+      staged[index] = staged[last];
+      entity[index] = entity[last];
+      rows[index] = rows[last];
+      rows[index]->m_index = index;
+    }
+    pos.pop_back();
+    pos_last.pop_back();
+    pos_tick.pop_back();
+    size.pop_back();
+    dir.pop_back();
+    moving.pop_back();
+    step.pop_back();
+    status.pop_back();
+    faction.pop_back();
+    owner.pop_back();
+    staged.pop_back();
+    entity.pop_back();
+    rows.pop_back();
+  }
+
+  std::vector<ComponentRow<T>*> rows;     ///< владельцы строк (для переноса номера)
+};
+
+
+/// \brief Строка экземпляра в ComponentTable, член-данные игровой сущности
+///
+/// Выделяет строку при создании экземпляра и освобождает при удалении.
+/// Доступ к данным строки - по номеру через таблицу, поэтому ссылки, возвращаемые
+/// методами, действительны только до создания или удаления экземпляров того же типа.
+/// Экземпляр с выделенной строкой не перемещается (Factory::Create создает его на месте).
+template <typename T>
+class ComponentRow {
+ public:
+  using Table = ComponentTable<T>;
+
+  /// \param item экземпляр, которому принадлежит строка
+  /// \param table таблица типа в мире экземпляра
+  ComponentRow(T* item, Table& table) : m_table(&table), m_index(table.Insert(item, this)) {}
+  ComponentRow(const ComponentRow&) = delete;
+  ComponentRow& operator=(const ComponentRow&) = delete;
+  ~ComponentRow() { m_table->Erase(m_index); }
+
+  unsigned getIndex() const { return m_index; }
+  const Table& getTable() const { return *m_table; }
+
+  sf::Vector2f& pos()           { return m_table->pos[m_index]; }
+  sf::Vector2f& posLast()       { return m_table->pos_last[m_index]; }
+  sf::Vector2f& size()          { return m_table->size[m_index]; }
+  direction&    dir()           { return m_table->dir[m_index]; }
+  state&        status()        { return m_table->status[m_index]; }
+  Faction&      faction()       { return m_table->faction[m_index]; }
+  int&          owner()         { return m_table->owner[m_index]; }
+
+  const sf::Vector2f& pos() const     { return m_table->pos[m_index]; }
+  const sf::Vector2f& posLast() const { return m_table->pos_last[m_index]; }
+  const sf::Vector2f& size() const    { return m_table->size[m_index]; }
+  direction     dir() const           { return m_table->dir[m_index]; }
+  state         status() const        { return m_table->status[m_index]; }
+  Faction       faction() const       { return m_table->faction[m_index]; }
+  int           owner() const         { return m_table->owner[m_index]; }
+
+  /// \brief задает перемещение на \a length вдоль dir на текущем шаге.
+  /// Позиция меняется не сразу, а проходом по массивам таблицы после обновления
+  /// всех экземпляров типа (EntityManager::IntegratePass)
+  void Move(float length) {
+    m_table->moving[m_index] = 1;
+    m_table->step[m_index] = length;
+  }
+
+  /// \brief включает строку в проходы по таблице (EntityRegistry::Flush).
+  /// Созданный экземпляр отображается сразу на своей позиции, без интерполяции
+  void Publish() {
+    m_table->staged[m_index] = 0;
+    m_table->pos_tick[m_index] = m_table->pos[m_index];
+  }
+
+ private:
+  friend class ComponentTable<T>;
+  Table*   m_table;                       ///< таблица, в которой выделена строка
+  unsigned m_index;                       ///< номер строки в таблице
+};
@@ -0,0 +1,65 @@
+#include "DrawList.h"
+
+void DrawList::Clear() {
+  m_vertices.clear();
+  m_shifts.clear();
+  m_batches.clear();
+  m_shift = sf::Vector2f();
+}
+
+
+void DrawList::Add(const sf::Sprite& sprite) {
+  const sf::IntRect& rect = sprite.getTextureRect();
+  sf::FloatRect bounds = sprite.getLocalBounds();
+  float left = float(rect.left);
+  float right = left + rect.width;
+  float top = float(rect.top);
+  float bottom = top + rect.height;
+  sf::Color color = sprite.getColor();
+  const sf::Vertex quad[4] = {
+    sf::Vertex({ 0, 0 },                         color, { left, top }),
+    sf::Vertex({ bounds.width, 0 },              color, { right, top }),
+    sf::Vertex({ bounds.width, bounds.height },  color, { right, bottom }),
+    sf::Vertex({ 0, bounds.height },             color, { left, bottom })
+  };
+  Append(sprite.getTexture(), quad, sprite.getTransform());
+}
+
+
+void DrawList::Add(const sf::VertexArray& quads, const sf::Texture* texture,
+                   const sf::Transform& transform) {
+  for (std::size_t i = 0; i + 3 < quads.getVertexCount(); i += 4) {
+    const sf::Vertex quad[4] = { quads[i], quads[i + 1], quads[i + 2], quads[i + 3] };
+    Append(texture, quad, transform);
+  }
+}
+
+
+void DrawList::Append(const sf::Texture* texture, const sf::Vertex* quad,
+                      const sf::Transform& transform) {
+  if (m_batches.empty() || m_batches.back().texture != texture) {
+    m_batches.push_back({ texture, m_vertices.size(), 0 });
+  }
+  for (int i = 0; i < 4; ++i) {
+    sf::Vertex vertex = quad[i];
+    vertex.position = transform.transformPoint(vertex.position);
+    m_vertices.push_back(vertex);
+  }
+  m_batches.back().count += 4;
+  m_shifts.push_back(m_shift);
+}
+
+
+void DrawList::Draw(sf::RenderTarget& target, float alpha) {
+  m_frame.resize(m_vertices.size());
+  for (std::size_t quad = 0; quad < m_shifts.size(); ++quad) {
+    sf::Vector2f offset = m_shifts[quad] * (alpha - 1);
+    for (std::size_t v = quad * 4; v < quad * 4 + 4; ++v) {
+      m_frame[v] = m_vertices[v];
+      m_frame[v].position += offset;
+    }
+  }
+  for (const Batch& batch : m_batches) {
+    target.draw(&m_frame[batch.first], batch.count, sf::Quads, sf::RenderStates(batch.texture));
+  }
+}
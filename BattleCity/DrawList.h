@@ -0,0 +1,60 @@
+/// \file
+/// \ingroup Visualisation
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include <SFML\Graphics.hpp>
+
+
+/// \ingroup Visualisation
+/// \brief Записанная сцена: текстурированные четырехугольники в координатах игрового поля
+///
+/// Сцена записывается потоком моделирования (GameEntity::Capture) и отображается
+/// потоком отображения (BattleSnapshot), поэтому не ссылается на юниты: спрайты и
+/// наборы вершин копируются в общий массив вершин, преобразованные в координаты поля.
+/// Подряд записанные элементы с одной текстурой объединяются в один вызов отображения.
+///
+/// Для каждого элемента хранится смещение юнита за последний шаг моделирования
+/// (setShift): при отображении элемент сдвигается назад на долю шага, оставшуюся
+/// до его позиции, т.е. интерполируется между двумя последними шагами.
+class DrawList {
+ public:
+  /// удаляет записанные элементы, сохраняя выделенную память
+  void Clear();
+
+  /// смещение юнита за последний шаг для последующих элементов (pos - pos_tick)
+  void setShift(sf::Vector2f shift) { m_shift = shift; }
+
+  /// записывает спрайт (текстура, фрагмент, преобразование и цвет)
+  void Add(const sf::Sprite& sprite);
+
+  /// записывает набор вершин примитива sf::Quads
+  /// \param transform преобразование вершин в координаты поля
+  void Add(const sf::VertexArray& quads, const sf::Texture* texture,
+           const sf::Transform& transform);
+
+  /// \brief отображает сцену
+  /// \param alpha доля шага моделирования, прошедшая после записи [0..1]
+  void Draw(sf::RenderTarget& target, float alpha);
+
+  std::size_t size() const { return m_shifts.size(); }   ///< количество четырехугольников
+
+ private:
+  /// вершины подряд отображаемых элементов с одной текстурой
+  struct Batch {
+    const sf::Texture*  texture;
+    std::size_t         first;
+    std::size_t         count;
+  };
+
+  /// добавляет четырехугольник, начиная пакет при смене текстуры
+  void Append(const sf::Texture* texture, const sf::Vertex* quad, const sf::Transform& transform);
+
+  std::vector<sf::Vertex>   m_vertices;     ///< вершины в координатах поля на момент записи
+  std::vector<sf::Vector2f> m_shifts;       ///< смещение за шаг для каждого четырехугольника
+  std::vector<Batch>        m_batches;
+  std::vector<sf::Vertex>   m_frame;        ///< вершины отображаемого кадра (Draw)
+  sf::Vector2f              m_shift;
+};
@@ -0,0 +1,353 @@
+/// \file
+/// \ingroup battle_city_game_classes
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+#include <SFML\Graphics.hpp>
+
+#include "BoundsCache.h"
+
+
+/// \ingroup interaction_processing_algorithms
+/// \brief Динамическое дерево ограничивающих областей (BVH) для отбора кандидатов
+/// \tparam T тип игровой сущности
+///
+/// Листья дерева хранят области юнитов, расширенные на \a margin ("толстые" области),
+/// внутренние узлы - объединение областей потомков. Пока юнит остается внутри своей
+/// толстой области, дерево не меняется; иначе лист переносится (удаление и вставка).
+/// Место вставки выбирается по наименьшему приросту периметра, после вставки и удаления
+/// дерево балансируется поворотами узлов по высоте поддеревьев, поэтому запрос по области
+/// стоит \f[ O(\log n + k) \f] независимо от размеров карты и юнитов.
+/// В отличие от SpatialGrid, юниты любого размера (например, границы карты) не
+/// ухудшают отбор.
+///
+/// Запрос возвращает кандидатов по толстым областям в порядке номеров,
+/// заданных при синхронизации, точная проверка выполняется отдельно.
+/// \see EntityManager::Broadphase, SpatialGrid
+template <typename T>
+class DynamicAabbTree {
+ public:
+  /// \param margin расширение области листа с каждой стороны
+  explicit DynamicAabbTree(float margin = 8) : m_margin(margin) {}
+
+  /// удаляет все листья
+  void Clear() {
+    m_nodes.clear();
+    m_index.clear();
+    m_root = kNull;
+    m_free = kNull;
+  }
+
+  /// \brief синхронизирует дерево с областями, сохраненными в кэше на текущем шаге:
+  /// добавляет новые юниты, переносит вышедшие из толстой области, удаляет исчезнувшие.
+  /// Номера юнитов в кэше передаются в Query.
+  void Update(BoundsCache<T>& cache) {
+    ++m_stamp;
+    for (unsigned id = 0; id < cache.size(); ++id) Sync(cache[id], cache.getBounds(id), id);
+    RemoveLost();
+  }
+
+  /// добавляет лист с областью \a rec
+  /// \param order номер, по которому упорядочиваются результаты запроса
+  /// \return номер листа
+  int CreateProxy(T& item, const sf::FloatRect& rec, unsigned order) {
+    int leaf = AllocateNode();
+    Node& node = m_nodes[leaf];
+    node.box = Fatten(rec);
+    node.item = &item;
+    node.order = order;
+    node.stamp = m_stamp;
+    node.height = 0;
+    InsertLeaf(leaf);
+    return leaf;
+  }
+
+  void DestroyProxy(int leaf) {
+    RemoveLeaf(leaf);
+    FreeNode(leaf);
+  }
+
+  /// \brief обновляет область листа
+  /// \return true, если лист вышел из толстой области и был перенесен
+  bool MoveProxy(int leaf, const sf::FloatRect& rec) {
+    Box box = ToBox(rec);
+    if (Contains(m_nodes[leaf].box, box)) return false;
+    RemoveLeaf(leaf);
+    m_nodes[leaf].box = Fatten(rec);
+    InsertLeaf(leaf);
+    return true;
+  }
+
+  /// \brief вызывает Operation(T&, unsigned order) для листьев, толстая область которых
+  /// пересекается с \a rec. Каждый лист передается один раз, в порядке номеров.
+  template <typename Operation>
+  void Query(const sf::FloatRect& rec, Operation op) {
+    m_found.clear();
+    if (m_root != kNull) {
+      Box box = ToBox(rec);
+      m_stack.clear();
+      m_stack.push_back(m_root);
+      while (!m_stack.empty()) {
+        int id = m_stack.back();
+        m_stack.pop_back();
+        const Node& node = m_nodes[id];
+        if (!Overlaps(node.box, box)) continue;
+        if (node.isLeaf()) {
+          m_found.push_back(id);
+        }
+        else {
+          m_stack.push_back(node.child1);
+          m_stack.push_back(node.child2);
+        }
+      }
+    }
+    std::sort(m_found.begin(), m_found.end(), [this](int l, int r) {
+      return m_nodes[l].order < m_nodes[r].order;
+    });
+    for (int id : m_found) op(*m_nodes[id].item, m_nodes[id].order);
+  }
+
+  /// высота дерева (0 - один лист, -1 - пустое дерево)
+  int getHeight() const { return m_root == kNull ? -1 : m_nodes[m_root].height; }
+
+ private:
+  static const int kNull = -1;
+
+  struct Box {
+    float left, top, right, bottom;
+  };
+
+  struct Node {
+    Box       box;
+    T*        item = nullptr;                  ///< юнит листа
+    int       parent = kNull;                  ///< родитель (или следующий свободный узел)
+    int       child1 = kNull;
+    int       child2 = kNull;
+    int       height = -1;                     ///< высота поддерева (-1 - узел свободен)
+    unsigned  order = 0;                       ///< номер юнита в наборе
+    unsigned  stamp = 0;                       ///< шаг последней синхронизации
+    bool isLeaf() const { return child1 == kNull; }
+  };
+
+  void Sync(T& item, const sf::FloatRect& rec, unsigned order) {
+    auto iter = m_index.find(&item);
+    if (iter == m_index.end()) {
+      m_index.emplace(&item, CreateProxy(item, rec, order));
+      return;
+    }
+    Node& node = m_nodes[iter->second];
+    node.order = order;
+    node.stamp = m_stamp;
+    MoveProxy(iter->second, rec);
+  }
+
+  /// удаляет листья юнитов, не встреченных при синхронизации
+  void RemoveLost() {
+    for (auto iter = m_index.begin(); iter != m_index.end(); ) {
+      if (m_nodes[iter->second].stamp != m_stamp) {
+        DestroyProxy(iter->second);
+        iter = m_index.erase(iter);
+      }
+      else {
+        ++iter;
+      }
+    }
+  }
+
+  static Box ToBox(const sf::FloatRect& rec) {
+    return { rec.left, rec.top, rec.left + rec.width, rec.top + rec.height };
+  }
+
+  Box Fatten(const sf::FloatRect& rec) const {
+    Box box = ToBox(rec);
+    box.left -= m_margin;  box.top -= m_margin;
+    box.right += m_margin; box.bottom += m_margin;
+    return box;
+  }
+
+  static Box Union(const Box& a, const Box& b) {
+    return { std::min(a.left, b.left), std::min(a.top, b.top),
+             std::max(a.right, b.right), std::max(a.bottom, b.bottom) };
+  }
+
+  static float Perimeter(const Box& a) {
+    return 2 * ((a.right - a.left) + (a.bottom - a.top));
+  }
+
+  static bool Contains(const Box& outer, const Box& inner) {
+    return outer.left <= inner.left && outer.top <= inner.top &&
+           inner.right <= outer.right && inner.bottom <= outer.bottom;
+  }
+
+  /// условие совпадает с sf::Rect::intersects
+  static bool Overlaps(const Box& a, const Box& b) {
+    return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+  }
+
+  int AllocateNode() {
+    int id;
+    if (m_free == kNull) {
+      id = static_cast<int>(m_nodes.size());
+      m_nodes.emplace_back();
+    }
+    else {
+      id = m_free;
+      m_free = m_nodes[id].parent;
+      m_nodes[id] = Node();
+    }
+    return id;
+  }
+
+  void FreeNode(int id) {
+    m_nodes[id] = Node();
+    m_nodes[id].parent = m_free;
+    m_free = id;
+  }
+
+  /// стоимость спуска в потомка при вставке области \a box
+  float DescendCost(int child, const Box& box) const {
+    const Node& node = m_nodes[child];
+    float cost = Perimeter(Union(box, node.box));
+    return node.isLeaf() ? cost : cost - Perimeter(node.box);
+  }
+
+  void InsertLeaf(int leaf) {
+    if (m_root == kNull) {
+      m_root = leaf;
+      m_nodes[leaf].parent = kNull;
+      return;
+    }
+    // выбор соседа: наименьший прирост периметра
+    Box box = m_nodes[leaf].box;
+    int index = m_root;
+    while (!m_nodes[index].isLeaf()) {
+      const Node& node = m_nodes[index];
+      float area = Perimeter(node.box);
+      float combined = Perimeter(Union(node.box, box));
+      float cost = 2 * combined;                   // новый родитель на этом уровне
+      float inheritance = 2 * (combined - area);   // прирост предков при спуске
+      float cost1 = DescendCost(node.child1, box) + inheritance;
+      float cost2 = DescendCost(node.child2, box) + inheritance;
+      if (cost < cost1 && cost < cost2) break;
+      index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    int sibling = index;
+    int old_parent = m_nodes[sibling].parent;
+    int new_parent = AllocateNode();
+    Node& parent = m_nodes[new_parent];
+    parent.parent = old_parent;
+    parent.box = Union(box, m_nodes[sibling].box);
+    parent.height = m_nodes[sibling].height + 1;
+    parent.child1 = sibling;
+    parent.child2 = leaf;
+    if (old_parent != kNull) {
+      if (m_nodes[old_parent].child1 == sibling) m_nodes[old_parent].child1 = new_parent;
+      else                                       m_nodes[old_parent].child2 = new_parent;
+    }
+    else {
+      m_root = new_parent;
+    }
+    m_nodes[sibling].parent = new_parent;
+    m_nodes[leaf].parent = new_parent;
+    Refit(new_parent);
+  }
+
+  void RemoveLeaf(int leaf) {
+    if (leaf == m_root) {
+      m_root = kNull;
+      return;
+    }
+    int parent = m_nodes[leaf].parent;
+    int grand = m_nodes[parent].parent;
+    int sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+    if (grand != kNull) {
+      if (m_nodes[grand].child1 == parent) m_nodes[grand].child1 = sibling;
+      else                                 m_nodes[grand].child2 = sibling;
+      m_nodes[sibling].parent = grand;
+      FreeNode(parent);
+      Refit(grand);
+    }
+    else {
+      m_root = sibling;
+      m_nodes[sibling].parent = kNull;
+      FreeNode(parent);
+    }
+    m_nodes[leaf].parent = kNull;
+  }
+
+  /// пересчитывает области и высоты от узла до корня, балансируя дерево
+  void Refit(int index) {
+    while (index != kNull) {
+      index = Balance(index);
+      Node& node = m_nodes[index];
+      const Node& c1 = m_nodes[node.child1];
+      const Node& c2 = m_nodes[node.child2];
+      node.height = 1 + std::max(c1.height, c2.height);
+      node.box = Union(c1.box, c2.box);
+      index = node.parent;
+    }
+  }
+
+  /// \brief поворот узла \a a, если высоты его поддеревьев различаются больше чем на 1
+  /// \return узел, занявший место \a a
+  int Balance(int a) {
+    Node& A = m_nodes[a];
+    if (A.isLeaf() || A.height < 2) return a;
+    int b = A.child1;
+    int c = A.child2;
+    int balance = m_nodes[c].height - m_nodes[b].height;
+    if (balance > 1)  return Rotate(a, c, b, false);
+    if (balance < -1) return Rotate(a, b, c, true);
+    return a;
+  }
+
+  /// поднимает потомка \a up узла \a a на его место, \a other - второй потомок \a a.
+  /// \param up_is_child1 \a up - первый потомок \a a
+  int Rotate(int a, int up, int other, bool up_is_child1) {
+    Node& A = m_nodes[a];
+    Node& U = m_nodes[up];
+    int f = U.child1;
+    int g = U.child2;
+
+    U.child1 = a;
+    U.parent = A.parent;
+    A.parent = up;
+    if (U.parent != kNull) {
+      if (m_nodes[U.parent].child1 == a) m_nodes[U.parent].child1 = up;
+      else                               m_nodes[U.parent].child2 = up;
+    }
+    else {
+      m_root = up;
+    }
+
+    // более высокое поддерево остается у поднятого узла
+    int keep = m_nodes[f].height > m_nodes[g].height ? f : g;
+    int give = keep == f ? g : f;
+    U.child2 = keep;
+    if (up_is_child1) A.child1 = give;
+    else              A.child2 = give;
+    m_nodes[give].parent = a;
+
+    const Node& O = m_nodes[other];
+    const Node& G = m_nodes[give];
+    const Node& K = m_nodes[keep];
+    A.box = Union(O.box, G.box);
+    A.height = 1 + std::max(O.height, G.height);
+    U.box = Union(A.box, K.box);
+    U.height = 1 + std::max(A.height, K.height);
+    return up;
+  }
+
+  std::vector<Node>             m_nodes;
+  int                           m_root = kNull;
+  int                           m_free = kNull;        ///< список свободных узлов
+  float                         m_margin;              ///< расширение области листа
+  std::unordered_map<const T*, int> m_index;           ///< юнит -> лист (Update)
+  unsigned                      m_stamp = 0;           ///< номер синхронизации
+  std::vector<int>              m_stack;               ///< обход при запросе
+  std::vector<int>              m_found;               ///< листья текущего запроса
+};
@@ -1,4 +1,5 @@
 #include "EntityBase.h"
+#include "World.h"
 
-sf::Vector2f GameEntity::m_local = { 0,0 };
-GameEntity::Entity_ptr_list GameEntity::g_entity_list;
+GameEntity::GameEntity(World& world) : m_world(world), m_wake_step(world.getStep()) {
+}
@@ -9,6 +9,7 @@
 
 #include <vector>
 #include <array>
+#include <unordered_map>
 #include <memory>
 #include <stdexcept>
 #include <utility>
@@ -16,27 +17,31 @@
 #include <SFML\Graphics.hpp>
 
 #include "Animating.h"
+#include "SlotMap.h"
+#include "EntityRegistry.h"
+#include "Components.h"
+#include "TypeTable.h"
+
+class World;
 
 
 /// \brief объекты, способные к взаимному механическому контакту
 /// 
 /// Базовый класс всех игровых объектов, поведение которых завист от их позиции и размеров. 
 /// Формирует интерфейс для алгоритма поиска геометрических пересечений.
-/// Через статический контейнер класса можно получить доступ ко всем имеющимся 
-///   экземплярам класса.
+/// Каждый экземпляр принадлежит миру (World), через который он получает доступ
+///   к хранилищам и параметрам типов своего мира.
 /// Единственный класс, работающий с конкретными экземплярами объектов (GameScenario) 
 /// не требует владения ими. И обращается через указатель в контейнере-хранилище.
 /// Экземпляры класса не могут коприроваться и присваиваться, т.к. описывают уникальные сущности.
 /// Оператор перемещения и копирования при перемещении требуется для использования контейнеров STL.
 /// Для помощи в управлении созданием, хранением и уничтожением многочисленными экземплярами 
 ///   GameEntity введен класс-шаблон Factory. 
-/// \see EntityManager::Update, EntityManager::Draw, Factory
+/// \see EntityManager::Update, EntityManager::Capture, Factory
 class GameEntity {
  public:
-  /// хранилище указателей "живущих" экземпляров класса. 
-  using Entity_ptr_list = std::list<std::shared_ptr<GameEntity>>;
-
-  GameEntity() = default;
+  /// \param world мир, которому принадлежит экземпляр
+  explicit GameEntity(World& world);
   GameEntity(GameEntity&)             = delete;
   GameEntity& operator=(GameEntity&)  = delete;
   GameEntity(GameEntity&&)            = default;
@@ -61,128 +66,198 @@ class GameEntity {
   virtual void Interaction(GameEntity&) = 0;
 
   virtual void Update(const sf::Time& )  = 0 ;
-  virtual void Draw(sf::RenderWindow& window) = 0;
+  /// записывает изображение юнита в сцену другого потока (EntityManager::Capture)
+  virtual void Capture(DrawList& list) = 0;
   virtual bool isDestroyed() const = 0;          ///< индикатор уничтожения 
-  static sf::Vector2f m_local;                   ///< начало координат системы отсчета позиции
 
-  /// при уделении элемента из этого контейнера удаляется сам объект в содержащем его 
-  /// контейнере. (Factory::s_current_set)
-  static Entity_ptr_list g_entity_list;
+  /// \brief отмечает изменение юнита, влияющее на взаимодействия (перемещение, 
+  /// поворот, появление, смена состояния)
+  /// \note определен в World.h
+  inline void Wake();
+
+  /// \brief юнит не изменялся с начала прошлой обработки взаимодействий.
+  /// Проверка пары спящих юнитов повторила бы прошлую проверку, которая ничего не изменила
+  /// (иначе юнит был бы разбужен), поэтому такие пары не проверяются.
+  /// \see EntityManager::Interaction
+  /// \note определен в World.h
+  inline bool isSleeping() const;
+
+ protected:
+  World&   m_world;                              ///< мир, которому принадлежит экземпляр
+
+ private:
+  unsigned m_wake_step;                          ///< номер обработки, перед которой юнит изменился
 };
 
 
 
-/// \brief Создает экземпляры GameEntity и размещает их в едином хранилище, для централизованного доступа
+/// \brief запись пакетного создания экземпляра (Factory::CreateBatch)
+struct SpawnRecord {
+  char          type = 0;               ///< подтип
+  sf::Vector2f  pos;                    ///< позиция на игровом поле
+  sf::Vector2f  size;                   ///< размер области (нулевой - размер подтипа)
+};
+
+
+/// \brief Создает экземпляры GameEntity и размещает их в хранилище своего мира
 /// \tparam  T  тип игровой сущности, 
 /// \tparam  T_info  параметры конкретного типа сущности
 /// 
-/// Продеставляет глобальный доступ к методу создания игровых единиц. 
+/// Экземпляр фабрики принадлежит миру (World::getFactory) и создается вместе с ним,
+///    поэтому в процессе может существовать несколько независимых миров.
 /// При создании предоставляет доступ по указателю к новому объекту, для его настроек.
-/// При создании каждый экземпляр размещается в статическом контейнере STL,
-///    инстанцированному для каждого типа наследников GameEntity.
-/// Также, контейнер STL ипользуется из-за его аллокатора для большего порядка в куче.
+/// При создании каждый экземпляр размещается в хранилище SlotMap фабрики.
+/// Хранилище размещает экземпляры блоками с постоянными адресами и повторно использует
+///    освобожденные ячейки, перебор экземпляров - линейный проход по блокам.
 /// Предоставляет централизованный доступ ко всем "живущим" экземплярам параметризующего класса T.
-/// Является подобием паттерна "фабрика" со статическим методом создания.
-/// Создает набор T_info, где лежат значения параметров конкретных подтипов (T::char type_) экземпляров класа T,
-///   загружая хначения из файла.
-/// Элеметны T_info хранилища выступают в роли разделяемых данных для 
-/// экземпляров игровых единиц соответствующего подтипа (T::char type_).
+/// Является подобием паттерна "фабрика".
+/// Использует набор T_info (TypeTable), где лежат значения параметров конкретных подтипов
+///   (T::char type_) экземпляров класа T, загружаемые из файла.
+/// Элеметны T_info набора выступают в роли разделяемых данных для 
+/// экземпляров игровых единиц соответствующего подтипа (T::char type_),
+///   экземпляр получает указатель на свою запись при создании.
+/// Набор не изменяется после загрузки и разделяется всеми мирами, загрузившими тот же файл.
 /// (структура экземпляров T опирается на паттерн "Flyweight")
 /// 
 /// Пример использования: \snippet Units.cpp demo_code_factory_create
 ///
-/// \see Tank, Bullet, Barrier, Bonus, GameScenario, EntityManager, example_unit_create.cpp
+/// \see World, Tank, Bullet, Barrier, Bonus, GameScenario, EntityManager, example_unit_create.cpp
 template <typename T, typename T_info>
 class Factory {
  public:
-  Factory(Factory&)        = delete;
-  Factory& operator= (Factory&)  = delete;
-
   /// тип контейнера, где хранятся экземпляры. 
-  // Список выбран, т.к. сохраняет итераторы действительными после произвольного удалениия
-  using CurrentSet = std::list<T>;
+  // адреса экземпляров постоянны, ячейки удаленных экземпляров используются повторно
+  using CurrentSet = SlotMap<T>;
 
-  /// тип при помощи которого предоставляется косвенный доступ к созданному экземпляру
-  using iterator = typename CurrentSet::iterator;
+  /// \brief тип при помощи которого предоставляется косвенный доступ к созданному экземпляру
+  /// Остается действительным после любых удалений, обращение к удаленному экземпляру
+  /// обнаруживается по поколению ячейки (SlotMap::Handle).
+  using iterator = typename CurrentSet::Handle;
 
   /// хранит набор параметров типа (T::char type_), разделяемых экземплярами 
-  using Collection = std::unordered_map<char, const T_info>;
+  using Collection = TypeTable<T_info>;
 
-  /// хранилище "живущих" на данный момент экземпл¤ров T
-  static CurrentSet s_current_set;
-  
-  /// хранилище параметров типа (T::char type_), разделяемых экземплярами 
-  static Collection s_collection;
+  /// часто используемые данные экземпляров (ComponentRow)
+  using Table = ComponentTable<T>;
+
+  /// \param world мир, которому принадлежат создаваемые экземпляры
+  /// \param registry реестр экземпляров мира, в нем регистрируется хранилище
+  Factory(World& world, EntityRegistry& registry)
+    : m_world(world), m_registry(registry), m_collection(std::make_shared<const Collection>()) {
+    registry.RegisterType(getTypeTag(), this, &Release, &Publish);
+  }
+  Factory(Factory&)        = delete;
+  Factory& operator= (Factory&)  = delete;
 
   /// создает новый экземпляр типа T, размещяет его в хранилище экземпляров
   /// и возвращает итератор на созданный элекмент.
   /// \param type подтип игровой единицы T::char type_
   /// \param time момент времени создания (от момента старта игровой сценты)
-  static iterator Create(char type, float time) {
+  iterator Create(char type, float time) {
     using namespace std;
-    if ( s_collection.find(type) == s_collection.end()) {
+    const T_info* info = m_collection->find(type);
+    if (!info) {
       cout << "not find type :" << type << endl;
-      if (s_collection.empty()) {
-        cout << "s_collection is empty." << endl; 
+      if (m_collection->empty()) {
+        cout << "collection is empty." << endl; 
       }
       getchar();
       throw invalid_argument("unknown type");
     }
-    // размещаем объекn в контйнере
-    s_current_set.push_back( T(type, time) );
-    // регистрируем указаетль на объект в контейнере с единым типом
-    auto iter = --s_current_set.end();  // итератор на размещенный объект
-    auto deleter = [iter](GameEntity* ptr) {
-      s_current_set.erase(iter);
-    };
-    GameEntity::g_entity_list.push_back(
-      shared_ptr<GameEntity>(&s_current_set.back(), deleter));
-    return --s_current_set.end();
+    // размещаем объекn в контйнере (на месте: экземпляр ссылается на строку ComponentTable)
+    // до конца шага объект доступен только по возвращаемой ссылке
+    iterator handle = m_current_set.emplace_with([this, info, time](void* place) {
+      ::new (place) T(m_world, *info, time);
+    }, true);
+    // регистрируем объект в реестре всех типов (включается в EntityRegistry::Flush)
+    m_registry.Stage({ getTypeTag(), handle.getIndex() });
+    return handle;
+  }
+  /// \brief создает экземпляры по набору записей одним проходом.
+  /// Подтипы всех записей проверяются до создания первого экземпляра, память хранилища,
+  /// строк ComponentTable и реестра выделяется один раз, каждый экземпляр сразу
+  /// создается на своей позиции конструктором T(World&, const T_info&, const SpawnRecord&, float).
+  /// Как и при Create, экземпляры включаются в проходы при EntityRegistry::Flush.
+  /// \param records  записи (подтип, позиция, размер)
+  /// \param count    количество записей
+  /// \param time     момент времени создания
+  void CreateBatch(const SpawnRecord* records, std::size_t count, float time) {
+    using namespace std;
+    for (std::size_t i = 0; i < count; ++i) {
+      if (!m_collection->find(records[i].type)) {
+        cout << "not find type :" << records[i].type << endl;
+        getchar();
+        throw invalid_argument("unknown type");
+      }
+    }
+    Reserve(m_current_set.size() + count);
+    m_registry.Reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      const SpawnRecord& record = records[i];
+      const T_info* info = m_collection->find(record.type);
+      iterator handle = m_current_set.emplace_with([&](void* place) {
+        ::new (place) T(m_world, *info, record, time);
+      }, true);
+      m_registry.Stage({ getTypeTag(), handle.getIndex() });
+    }
   }
-  // загрузка набора разделяемых данных конкретных подтипов класса T из файла в коллекцию класса
-  static void LoadCollection(const std::string& file);
- 
- private:
-  // Изначально планировоалось определить класс как Singleton,
-  // с тех пор осталось. пока так.
-  Factory(std::string type_file);
-};
-
 
-template <typename T, typename T_info>
-void Factory<T, T_info>::LoadCollection(const std::string& file) {
-  using namespace std;
-
-  ifstream fin(file);
-  if (!fin.is_open()) {
-    cout << "No find file: " << file << endl;
-    getchar();
-    throw invalid_argument("Can't open tiles file");
+  void CreateBatch(const std::vector<SpawnRecord>& records, float time) {
+    CreateBatch(records.data(), records.size(), time);
   }
 
-  string line, name;
-  int line_cnt = 0;
-  while (getline(fin, line)) {
-    ++line_cnt;
-    if (line[0] == '#') continue;  // comments
+  /// загрузка набора разделяемых данных конкретных подтипов класса T из файла
+  /// (набор, уже загруженный из того же файла, используется повторно)
+  void LoadCollection(const std::string& file) { m_collection = Collection::Load(file); }
 
-    istringstream is(line);
-    T_info tmp_info;
-    if (is >> tmp_info) {
-      s_collection.emplace(tmp_info.type, std::move(tmp_info));
-    }
-    else {
-      cout << " can't load line N " << line_cnt << " : ";
-      cout << line << endl;
-      getchar();
-      throw invalid_argument("Can't load tile sprites");
-    }
+  /// \brief задает готовый набор подтипов.
+  /// Экземпляры, созданные по прежнему набору, должны быть удалены до его замены.
+  void setCollection(std::shared_ptr<const Collection> collection) {
+    m_collection = collection ? std::move(collection) : std::make_shared<const Collection>();
+  }
+
+  /// \brief заранее выделяет хранилище и строки ComponentTable для \a count экземпляров.
+  /// Ячейки удаленных экземпляров занимаются повторно, поэтому, пока одновременно
+  /// существует не более \a count экземпляров, создание не выделяет память.
+  void Reserve(std::size_t count) {
+    m_current_set.reserve(count);
+    m_table.reserve(count);
   }
-  return;
-}
 
-template <typename T1, typename T2>
-typename Factory<T1, T2>::CurrentSet Factory<T1, T2>::s_current_set;
+  /// хранилище "живущих" на данный момент экземпляров T
+  CurrentSet& getCurrentSet()             { return m_current_set; }
+  const CurrentSet& getCurrentSet() const { return m_current_set; }
 
-template <typename T1, typename T2>
-typename Factory<T1, T2>::Collection Factory<T1, T2>::s_collection;
+  /// хранилище параметров типа (T::char type_), разделяемых экземплярами 
+  const Collection& getCollection() const { return *m_collection; }
+
+  Table& getTable()                       { return m_table; }
+  const Table& getTable() const           { return m_table; }
+
+  /// очередной уникальный номер экземпляра
+  int NextId() { return m_id_cnt++; }
+
+  /// \brief номер типа в реестрах EntityRegistry, общий для всех миров.
+  /// Выдается при первом обращении.
+  static std::uint8_t getTypeTag() {
+    static const std::uint8_t tag = EntityRegistry::NewTypeTag();
+    return tag;
+  }
+ 
+ private:
+  static void Release(void* factory, unsigned index) {
+    static_cast<Factory*>(factory)->m_current_set.erase(index);
+  }
+  static void Publish(void* factory, unsigned index) {
+    Factory& self = *static_cast<Factory*>(factory);
+    self.m_current_set.Publish(index);
+    self.m_current_set[index].m_hot.Publish();
+  }
+
+  World&          m_world;
+  EntityRegistry& m_registry;
+  std::shared_ptr<const Collection> m_collection;  ///< набор подтипов, переживает экземпляры
+  Table           m_table;              ///< удаляется после экземпляров, освобождающих строки
+  CurrentSet      m_current_set;
+  int             m_id_cnt = 0;         ///< отсчитывает уникальные номера
+};
@@ -1,40 +1,290 @@
 #include "EntityManager.h"
 
 void EntityManager::Update(const sf::Time& time) {
-  GameEntity::Entity_ptr_list::iterator support;
-  for (auto first = GameEntity::g_entity_list.begin(); first != GameEntity::g_entity_list.end(); )
-  {
-    if ((*first)->isDestroyed()) {
-      support = first;   // because list iterator will be lost
-      ++support;
-      GameEntity::g_entity_list.erase(first);
-      first = support;
+  //       (DrawList::setShift)
+  ForEachType(EntityTypes(), [this](auto tag) {
+    m_world.getFactory<typename decltype(tag)::type>().getTable().SaveTickPositions();
+  });
+  //      EntityTypes: ,  ,
+  //       .   ,
+  //   ,       
+  ForEachType(EntityTypes(), [this, &time](auto tag) {
+    using T = typename decltype(tag)::type;
+    UpdatePass<T>(time);
+    IntegratePass<T>(IsMoving<T>());
+  });
+}
+
+void EntityManager::Capture(DrawList& list) {
+  ForEachType(DrawLayers(), [this, &list](auto tag) {
+    CapturePass<typename decltype(tag)::type>(list);
+  });
+  //    () 
+  list.setShift(sf::Vector2f());
+  const auto& barriers = m_world.getFactory<Barrier>().getTable();
+  for (unsigned row = 0; row < barriers.getRowsNum(); ++row) {
+    Barrier& item = *barriers.entity[row];
+    if (!barriers.staged[row] && item.isTopDrawLayer()) item.Capture(list);
+  }
+}
+
+//       (EntityManager::CollectPairs)
+
+template <>
+void EntityManager::CollectPairs<Tank, Tank>() {
+  //       ;     
+  //  ,   -    
+  m_tank_pairs.clear();
+  for (unsigned id = 0; id < m_tank_bounds.size(); ++id) {
+    if (m_tank_bounds[id].isSleeping()) continue;
+    QueryTanks(m_tank_bounds.getBounds(id), [this, id](Tank& other, unsigned other_id) {
+      if (other_id == id) return;
+      if (other_id > id) m_tank_pairs.emplace_back(id, other_id);
+      else if (other.isSleeping()) m_tank_pairs.emplace_back(other_id, id);
+    });
+  }
+  //   -    unique_combination
+  std::sort(m_tank_pairs.begin(), m_tank_pairs.end());
+  for (auto& pair : m_tank_pairs) {
+    AddContact(m_tank_bounds[pair.first], m_tank_bounds.getBounds(pair.first),
+               m_tank_bounds[pair.second], m_tank_bounds.getBounds(pair.second));
+  }
+}
+
+template <>
+void EntityManager::CollectPairs<Tank, Barrier>() {
+  //  ,       
+  for (unsigned id = 0; id < m_tank_bounds.size(); ++id) {
+    Tank& tank = m_tank_bounds[id];
+    if (tank.isSleeping()) continue;
+    const sf::FloatRect& rec = m_tank_bounds.getBounds(id);
+    m_tile_map.ForEachTile(rec,
+        [this, &tank, &rec](const TileMap::Tile& tile, unsigned x, unsigned y) {
+      if (!tile.obstruct_Z_eq_0) AddContact(tank, rec, *tile.barrier, tile.bounds, x, y, true);
+    });
+    QueryFreeBarriers(rec, [this, &tank, &rec](Barrier& barrier, unsigned barrier_id) {
+      AddContact(tank, rec, barrier, m_free_bounds[barrier_id]);
+    });
+  }
+}
+
+template <>
+void EntityManager::CollectPairs<Tank, Bonus>() {
+  for (unsigned id = 0; id < m_tank_bounds.size(); ++id) {
+    Tank& tank = m_tank_bounds[id];
+    const sf::FloatRect& rec = m_tank_bounds.getBounds(id);
+    m_bonus_bounds.Query(rec, [this, &tank, &rec](Bonus& bonus, unsigned bonus_id) {
+      if (tank.isSleeping() && bonus.isSleeping()) return;
+      AddContact(tank, rec, bonus, m_bonus_bounds.getExactBounds(bonus_id));
+    });
+  }
+}
+
+template <>
+void EntityManager::CollectPairs<Tank, Bullet>() {
+  auto& pairs = m_sweep.getMixedPairs();
+  for (std::size_t i = 0; i < pairs.size(); ++i) {
+    auto ids = m_sweep.getMixedIds(i);
+    AddContact(*pairs[i].first, m_tank_bounds.getExactBounds(ids.first),
+               *pairs[i].second, m_bullet_bounds.getBounds(ids.second));
+  }
+}
+
+template <>
+void EntityManager::CollectPairs<Bullet, Bullet>() {
+  auto& pairs = m_sweep.getSamePairs();
+  for (std::size_t i = 0; i < pairs.size(); ++i) {
+    auto ids = m_sweep.getSameIds(i);
+    AddContact(*pairs[i].first, m_bullet_bounds.getExactBounds(ids.first),
+               *pairs[i].second, m_bullet_bounds.getExactBounds(ids.second));
+  }
+}
+
+template <>
+void EntityManager::CollectPairs<Bullet, Barrier>() {
+  for (unsigned id = 0; id < m_bullet_bounds.size(); ++id) {
+    Bullet& bullet = m_bullet_bounds[id];
+    if (bullet.isDestroyed()) continue;
+    const sf::FloatRect& swept = m_bullet_bounds.getBounds(id);
+    m_tile_map.ForEachTile(swept,
+        [this, &bullet, &swept](const TileMap::Tile& tile, unsigned x, unsigned y) {
+      if (!tile.obstruct_Z_greater_0) {
+        AddContact(bullet, swept, *tile.barrier, tile.bounds, x, y, true);
+      }
+    });
+    QueryFreeBarriers(swept, [this, &bullet, &swept](Barrier& barrier, unsigned barrier_id) {
+      AddContact(bullet, swept, barrier, m_free_bounds[barrier_id]);
+    });
+  }
+}
+
+template <>
+void EntityManager::CollectPairs<Bullet, Bonus>() {
+  for (unsigned id = 0; id < m_bullet_bounds.size(); ++id) {
+    Bullet& bullet = m_bullet_bounds[id];
+    if (bullet.isDestroyed()) continue;
+    const sf::FloatRect& swept = m_bullet_bounds.getBounds(id);
+    m_bonus_bounds.Query(swept, [this, &bullet, &swept](Bonus& bonus, unsigned bonus_id) {
+      AddContact(bullet, swept, bonus, m_bonus_bounds.getExactBounds(bonus_id));
+    });
+  }
+}
+
+
+void EntityManager::Interaction() {
+  // ,     ,   (GameEntity::isSleeping)
+  m_world.NextStep();
+
+  //         
+  m_tank_order.Step(m_world.getFactory<Tank>().getTable(), m_order_cell, kOrderBudget);
+  m_bullet_order.Step(m_world.getFactory<Bullet>().getTable(), m_order_cell, kOrderBudget);
+
+  //      BroadBounds:     
+  //     ,     
+  // (    ComponentTable,    )
+  m_tank_bounds.Fill(m_world.getFactory<Tank>().getTable());
+  m_bonus_bounds.Fill(m_world.getFactory<Bonus>().getTable());
+  if (m_broadphase == Broadphase::AABB_TREE) m_tank_tree.Update(m_tank_bounds);
+  else                                        m_tank_grid.Build(m_tank_bounds);
+
+  const InteractionStage stages[] = {
+    InteractionStage::COLLISION, InteractionStage::TERRAIN, InteractionStage::SWEPT
+  };
+  for (InteractionStage stage : stages) {
+    //       ,  
+    // NarrowPhase (Contact)    
+    if (stage != InteractionStage::COLLISION) {
+      m_tank_bounds.Fill(m_world.getFactory<Tank>().getTable());
+    }
+    if (stage == InteractionStage::SWEPT) {
+      m_bullet_bounds.Fill(m_world.getFactory<Bullet>().getTable());
+      m_sweep.Update(m_tank_bounds, m_bullet_bounds);
     }
-    else {
-      (*first)->Update(time);
-      ++first;
+    CollectStage(stage);
+    NarrowPhase(m_contacts);
+    CountContacts();
+    if (stage == InteractionStage::SWEPT) {
+      m_contacts.erase(std::remove_if(m_contacts.begin(), m_contacts.end(),
+                                      [](const Contact& c) { return !c.hit; }),
+                       m_contacts.end());
+      //    ,       
+      std::stable_sort(m_contacts.begin(), m_contacts.end(),
+        [](const Contact& a, const Contact& b) { return a.toi < b.toi; });
     }
+    ApplyContacts();
+  }
+}
+
+void EntityManager::ApplyCommands() {
+  m_world.getRegistry().Flush();
+}
+
+void EntityManager::CollectStage(InteractionStage stage) {
+  m_contacts.clear();
+  ForEachInteractionPair(EntityTypes(), [this, stage](auto first, auto second) {
+    using T1 = typename decltype(first)::type;
+    using T2 = typename decltype(second)::type;
+    if (PairStage<T1, T2>::value == stage) CollectPairs<T1, T2>();
+  });
+}
+
+void EntityManager::NarrowPhase(std::vector<Contact>& contacts) {
+  ThreadPool::Shared().ParallelFor(contacts.size(), kNarrowPhaseGrain,
+    [&contacts](std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; ++i) contacts[i].test(contacts[i]);
+    });
+}
+
+void EntityManager::CountContacts() {
+  for (const auto& c : m_contacts) {
+    PairCounter& counter = m_pair_counters[c.pair];
+    ++counter.tests;
+    if (c.hit) ++counter.hits;
   }
 }
 
-void EntityManager::Draw(sf::RenderWindow& window) {
-  for (auto& item : GameEntity::g_entity_list) {
-    item->Draw(window);
+void EntityManager::ApplyContacts() {
+  m_moved.clear();
+  bool free_destroyed = false;
+  for (auto& c : m_contacts) {
+    // NarrowPhase      :   
+    //   ,     
+    if (!c.hit && !m_moved.empty() && (isMoved(c.first) || isMoved(c.second))) c.retest(c);
+    if (!c.hit) continue;
+    sf::Vector2f first_pos = c.first->getPosition();
+    sf::Vector2f second_pos = c.second->getPosition();
+    c.apply(c);
+    if (c.first->getPosition() != first_pos) m_moved.push_back(c.first);
+    if (c.second->getPosition() != second_pos) m_moved.push_back(c.second);
+    //        
+    if (c.second->isDestroyed()) {
+      if (c.tile) m_tile_map.Erase(c.x, c.y);
+      else        free_destroyed = true;
+    }
   }
-  //     ()
-  for (auto& item : Barrier::factory::s_current_set) {
-    if(item.isTopDrawLayer()) item.Draw(window);
+  if (free_destroyed) EraseDestroyedFreeBarriers();
+}
+
+bool EntityManager::isMoved(const GameEntity* item) const {
+  return std::find(m_moved.begin(), m_moved.end(), item) != m_moved.end();
+}
+
+void EntityManager::printPairStatistics(const std::string& label) const {
+#ifdef BATTLE_CITY_ENTITY_STATISTICS
+  using namespace std;
+  cout << endl << label << endl;
+  cout << "Interaction pairs (tests / hits) : " << endl;
+  ForEachInteractionPair(EntityTypes(), [this](auto first, auto second) {
+    using T1 = typename decltype(first)::type;
+    using T2 = typename decltype(second)::type;
+    const PairCounter& counter = getPairCounter<T1, T2>();
+    cout << EntityName<T1>::get() << " - " << EntityName<T2>::get() << " \t: "
+         << counter.tests << " / " << counter.hits << endl;
+  });
+#else
+  (void)label;
+#endif
+}
+
+void EntityManager::BuildTileMap(sf::Vector2u cells, sf::Vector2f block) {
+  m_order_cell = block;
+  m_barrier_order.Sort(m_world.getFactory<Barrier>().getTable(), block);
+  m_tile_map.Reset(cells, block);
+  m_free_barriers.clear();
+  m_free_bounds.clear();
+  for (auto& item : m_world.getFactory<Barrier>().getCurrentSet()) {
+    if (!m_tile_map.Place(item)) {
+      m_free_barriers.push_back(&item);
+      m_free_bounds.push_back(item.getBounds());
+    }
   }
+  BuildBarrierTree();
 }
 
-void EntityManager::Interaction() {
-  sf::Clock cl;
+void EntityManager::EraseDestroyedFreeBarriers() {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < m_free_barriers.size(); ++i) {
+    if (m_free_barriers[i]->isDestroyed()) continue;
+    m_free_barriers[count] = m_free_barriers[i];
+    m_free_bounds[count] = m_free_bounds[i];
+    ++count;
+  }
+  if (count == m_free_barriers.size()) return;
+  m_free_barriers.resize(count);
+  m_free_bounds.resize(count);
+  BuildBarrierTree();
+}
 
-  SingleTipeCombine<Tank>();
-  DoubleTypeCombine<Tank, Bullet>();
-  DoubleTypeCombine<Tank, Barrier>();
-  DoubleTypeCombine<Tank, Bonus>();
-  SingleTipeCombine<Bullet>();
-  DoubleTypeCombine<Bullet, Barrier>();
-  DoubleTypeCombine<Bullet, Bonus>();
+void EntityManager::BuildBarrierTree() {
+  m_barrier_tree.Clear();
+  for (unsigned id = 0; id < m_free_barriers.size(); ++id) {
+    m_barrier_tree.CreateProxy(*m_free_barriers[id], m_free_bounds[id], id);
+  }
 }
+
+void EntityManager::setBroadphase(Broadphase broadphase) {
+  if (m_broadphase == broadphase) return;
+  m_broadphase = broadphase;
+  //       
+  m_tank_tree.Clear();
+}
\ No newline at end of file
@@ -2,10 +2,23 @@
 /// \ingroup battle_city_game_classes
 #pragma once
 
+#include <string>
+#include <vector>
+#include <array>
+#include <type_traits>
+
 #include <SFML\Graphics.hpp>
 
 #include "EntityBase.h"
 #include "Units.h"
+#include "SpatialGrid.h"
+#include "TileMap.h"
+#include "SweepAndPrune.h"
+#include "MortonOrder.h"
+#include "DynamicAabbTree.h"
+#include "ThreadPool.h"
+#include "EntityTypes.h"
+#include "World.h"
 
 
 ///  \brief ќсуществл¤ет централизованное управление экземпл¤рами GameEntity 
@@ -16,21 +29,254 @@
 /// ¬ то врем¤, как Factory отвечает за создание и учет объектов GameEntity, EntityManager
 /// отвечает за обновление их состо¤ний и удаление.
 /// 
-/// –еализаци¤ методов использует хранилища классов GameEntity::Entity_ptr_list 
-/// и Factory::CurrentSet дл¤ доступа к наборам экземпл¤ров.
+/// Реализация методов использует хранилища своего мира (World::getFactory)
+/// и его реестр экземпляров (World::getRegistry).
 /// \see interaction_processing_algorithms, Factory, BattleCity::Update
 class EntityManager {
  public:
+  /// \param world мир, экземпляры которого обрабатываются
+  explicit EntityManager(World& world) : m_world(world) {}
+
   /// обновляет состо¤ние всех игровых единиц
   /// \param time врем¤ от начала старта
   void Update(const sf::Time& time);
 
-  /// ¬ыводит графическое представление в окне программы
-  void Draw(sf::RenderWindow&);
+  /// \brief записывает сцену по слоям DrawLayers для отображения другим потоком (BattleThread).
+  /// Юниты записываются в текущих позициях со смещением за последний шаг (DrawList::setShift)
+  void Capture(DrawList& list);
 
   /// ќбрабатывает попарные взаимодействи¤ всех существующих на данном шаге объектов
   /// при столкновении (когда становитс¤ не пустой область пересечени¤ их геометрических форм)
   void Interaction();
+
+  /// применяет отложенные за шаг изменения: вызывает команды уничтоженных юнитов,
+  /// удаляет уничтоженные экземпляры и включает созданные (EntityRegistry::Flush)
+  /// \note вызывается в конце шага, после сценария игры (BattleCity::Update)
+  void ApplyCommands();
+
+  /// распределяет препятствия по клеткам карты, остальные (границы поля) 
+  /// проверяются отдельным списком
+  /// \param cells размер карты в клетках
+  /// \param block размер клетки
+  /// \pre препятствия карты уже созданы (BattleCity::Start)
+  void BuildTileMap(sf::Vector2u cells, sf::Vector2f block);
+
+  /// структура отбора пар танк-танк и пар с препятствиями вне клеток карты
+  enum class Broadphase {
+    GRID,                                   ///< равномерная сетка и перебор списка препятствий
+    AABB_TREE                               ///< динамические деревья областей (DynamicAabbTree)
+  };
+
+  /// \brief наибольшее число клеток карты, при котором выбирается Broadphase::GRID,
+  /// на больших картах - AABB_TREE (BattleCity::Start).
+  /// Сетка и перебор списка препятствий быстрее на картах уровней игры (26 x 26 клеток),
+  /// но стоимость сетки растет с площадью поля, а деревьев - только с числом юнитов.
+  /// Граница 64 x 64 клетки с запасом больше всех карт уровней.
+  static const unsigned kGridMaxCells = 64 * 64;
+
+  /// выбирает структуру отбора, может меняться между шагами
+  void setBroadphase(Broadphase broadphase);
+  Broadphase getBroadphase() const { return m_broadphase; }
+
+  /// счетчики проверок пары типов
+  struct PairCounter {
+    unsigned long long tests = 0;           ///< пары, переданные на проверку NarrowPhase
+    unsigned long long hits = 0;            ///< пары, прошедшие проверку
+  };
+
+  /// счетчики пары типов (T1, T2) за время жизни менеджера
+  template <typename T1, typename T2>
+  const PairCounter& getPairCounter() const { return m_pair_counters[PairIndex<T1, T2>()]; }
+
+  /// выводит счетчики всех пар типов (при определенном BATTLE_CITY_ENTITY_STATISTICS)
+  void printPairStatistics(const std::string& label) const;
+
+ private:
+  /// \brief обновляет экземпляры типа T в порядке ячеек хранилища и в том же проходе
+  /// записывает уничтоженные на удаление в конце шага. Тип известен на этапе компиляции,
+  /// а наследники GameEntity объявлены final, поэтому вызовы Update не виртуальные
+  /// и встраиваются.
+  template <typename T>
+  void UpdatePass(const sf::Time& time) {
+    auto& set = m_world.getFactory<T>().getCurrentSet();
+    for (auto iter = set.begin(), end = set.end(); iter != end; ++iter) {
+      if (iter->isDestroyed()) {
+        m_world.getRegistry().Destroy({ T::factory::getTypeTag(), iter.getIndex() });
+        continue;
+      }
+      iter->Update(time);
+    }
+  }
+
+  /// \brief перемещает экземпляры типа T, задавшие перемещение в Update (ComponentRow::Move),
+  /// линейным проходом по массивам pos, dir и step таблицы: pos_last = pos; pos += shift
+  template <typename T>
+  void IntegratePass(std::true_type) {
+    auto& table = m_world.getFactory<T>().getTable();
+    for (unsigned row = 0; row < table.getRowsNum(); ++row) {
+      if (!table.moving[row]) continue;
+      table.moving[row] = 0;
+      table.pos_last[row] = table.pos[row];
+      table.pos[row] += MovingShift2D(table.step[row], 1, table.dir[row]);
+    }
+  }
+
+  /// неподвижные типы (IsMoving) не перемещаются
+  template <typename T>
+  void IntegratePass(std::false_type) {}
+
+  /// записывает экземпляры типа T (слой сцены) в порядке строк ComponentTable,
+  /// т.е. соседние на поле юниты подряд (MortonOrder)
+  template <typename T>
+  void CapturePass(DrawList& list) {
+    const auto& table = m_world.getFactory<T>().getTable();
+    for (unsigned row = 0; row < table.getRowsNum(); ++row) {
+      if (table.staged[row]) continue;
+      list.setShift(table.pos[row] - table.pos_tick[row]);
+      table.entity[row]->Capture(list);
+    }
+  }
+
+  World& m_world;                           ///< мир, экземпляры которого обрабатываются
+
+  // сетки отбора кандидатов на взаимодействие, перестраиваются на каждом шаге
+  SpatialGrid<Tank>     m_tank_grid;
+
+  // деревья отбора: танки синхронизируются на каждом шаге, препятствия - в BuildTileMap
+  DynamicAabbTree<Tank>     m_tank_tree;
+  DynamicAabbTree<Barrier>  m_barrier_tree;
+  Broadphase                m_broadphase = Broadphase::GRID;
+
+  /// вызывает Operation(Tank&, unsigned id) для танков, чья область может пересекаться
+  /// с \a rec; id - номер танка в m_tank_bounds
+  template <typename Operation>
+  void QueryTanks(const sf::FloatRect& rec, Operation op) {
+    if (m_broadphase == Broadphase::AABB_TREE) m_tank_tree.Query(rec, op);
+    else                                        m_tank_grid.Query(rec, op);
+  }
+
+  /// вызывает Operation(Barrier&, unsigned id) для препятствий вне клеток карты, 
+  /// которые могут пересекаться с \a rec, в порядке m_free_barriers;
+  /// id - номер препятствия в m_free_barriers
+  template <typename Operation>
+  void QueryFreeBarriers(const sf::FloatRect& rec, Operation op) {
+    if (m_broadphase == Broadphase::AABB_TREE) {
+      m_barrier_tree.Query(rec, op);
+    }
+    else {
+      for (unsigned id = 0; id < m_free_barriers.size(); ++id) op(*m_free_barriers[id], id);
+    }
+  }
+
+  // упорядочивание строк таблиц по Z-порядку клеток: подвижные юниты - частично
+  // на каждом шаге, препятствия - полностью в BuildTileMap
+  MortonOrder<Tank>     m_tank_order;
+  MortonOrder<Bullet>   m_bullet_order;
+  MortonOrder<Barrier>  m_barrier_order;
+  sf::Vector2f          m_order_cell = { 16, 16 };  ///< клетка ключа (клетка карты)
+  static const unsigned kOrderBudget = 256;         ///< перестановок строк таблицы за шаг
+
+  // области юнитов, записанные в начале обработки взаимодействий
+  // (танки перезаписываются перед каждым следующим этапом, после смещений)
+  BoundsCache<Tank>     m_tank_bounds;
+  BoundsCache<Bonus>    m_bonus_bounds;
+  BoundsCache<Bullet>   m_bullet_bounds;            ///< области снарядов на этапе SWEPT
+
+  /// пары снаряд-снаряд и танк-снаряд, сохраняется между шагами
+  SweepAndPrune<Tank, Bullet> m_sweep;
+
+  /// пара юнитов, отобранная для проверки взаимодействия
+  struct Contact {
+    GameEntity* first;                      ///< первый аргумент EntityInteraction
+    GameEntity* second;                     ///< второй аргумент EntityInteraction
+    sf::FloatRect first_bounds;             ///< NarrowBounds первого участника при отборе
+    sf::FloatRect second_bounds;            ///< NarrowBounds второго участника при отборе
+    std::size_t pair;                       ///< номер пары типов (PairIndex)
+    void      (*test)(Contact&);            ///< проверка по областям отбора (TestPair)
+    void      (*retest)(Contact&);          ///< проверка по текущим областям (RetestPair)
+    void      (*apply)(Contact&);           ///< взаимодействие для типов пары (ApplyPair)
+    unsigned    x, y;                       ///< клетка карты препятствия (TileMap)
+    bool        tile;                       ///< второй участник размещен в клетке карты
+    bool        hit;                        ///< результат проверки NarrowPhase
+    float       toi;                        ///< доля перемещения снаряда до касания
+  };
+
+  /// \param first_bounds,second_bounds области NarrowBounds участников, взятые из кэшей
+  template <typename T1, typename T2>
+  void AddContact(T1& first, const sf::FloatRect& first_bounds,
+                  T2& second, const sf::FloatRect& second_bounds,
+                  unsigned x = 0, unsigned y = 0, bool tile = false);
+
+  template <typename T1, typename T2>
+  static void TestPair(Contact& contact);
+
+  template <typename T1, typename T2>
+  static void RetestPair(Contact& contact);
+
+  template <typename T1, typename T2>
+  static void ApplyPair(Contact& contact);
+
+  /// \brief отбирает пары (T1, T2) для проверки.
+  /// По умолчанию перебираются все сочетания хранилищ, кроме пар спящих юнитов;
+  /// для существующих типов определены специализации с сетками и картой клеток.
+  template <typename T1, typename T2>
+  void CollectPairs();
+
+  /// отбирает пары всех типов, обрабатываемых на этапе \a stage (PairStage)
+  void CollectStage(InteractionStage stage);
+
+  /// \brief проверяет все отобранные пары, распределяя список между потоками ThreadPool
+  ///
+  /// Проверка только читает состояние юнитов и записывает результат в свой элемент
+  /// списка, поэтому результат не зависит от числа потоков и порядка их работы.
+  /// Области участников берутся из элемента списка (записаны при отборе из кэшей
+  /// BoundsCache, TileMap и m_free_bounds), без виртуальных вызовов getBounds.
+  static void NarrowPhase(std::vector<Contact>& contacts);
+
+  /// \brief наименьший блок пар, передаваемый потоку NarrowPhase; список не длиннее
+  /// проверяется в вызывающем потоке.
+  /// Проверка пары - сравнение областей (единицы наносекунд), а передача блока потокам
+  /// и ожидание их завершения - единицы микросекунд, поэтому блок должен содержать
+  /// тысячи пар. На картах уровней игры (26 x 26 клеток, до 20 танков) этап дает
+  /// десятки - сотни пар и всегда проверяется в одном потоке; потоки используются только
+  /// в больших битвах. Значение уточняется замером скорости шагов (BattleCity --headless)
+  static const std::size_t kNarrowPhaseGrain = 2048;
+
+  /// добавляет результаты проверки текущего списка к счетчикам пар
+  void CountContacts();
+
+  /// \brief вызывает EntityInteraction для пар, прошедших проверку, в порядке списка
+  ///
+  /// Изменения состояния юнитов выполняются только здесь, в одном потоке.
+  /// Результат совпадает с последовательным вызовом EntityInteraction для каждой пары
+  /// списка: EntityInteraction сама повторяет проверку по текущим позициям, поэтому
+  /// прошедшие NarrowPhase пары, разведенные предыдущими смещениями, ничего не меняют;
+  /// а не прошедшие пары с юнитом, смещенным ранее на этом же этапе (танк, возвращенный
+  /// столкновением), проверяются заново по текущим областям (RetestPair). Проверка NarrowTest не уже
+  /// проверки EntityInteraction, поэтому остальные отклоненные пары не сработали бы и
+  /// при последовательном обходе. На этапе SWEPT юниты не смещаются (StopAt - только
+  /// вместе с уничтожением снаряда), и список содержит лишь прошедшие проверку пары.
+  void ApplyContacts();
+
+  /// юнит смещен взаимодействием на текущем этапе (ApplyContacts)
+  bool isMoved(const GameEntity* item) const;
+
+  /// \brief исключает уничтоженные препятствия из m_free_barriers и дерева отбора.
+  /// Уничтоженный экземпляр удаляется из хранилища только на следующем шаге,
+  /// поэтому списки очищаются сразу после взаимодействия (ApplyContacts)
+  void EraseDestroyedFreeBarriers();
+
+  /// заполняет дерево отбора препятствий по m_free_barriers
+  void BuildBarrierTree();
+
+  std::vector<Contact>  m_contacts;       ///< пары текущего этапа обработки
+  std::vector<const GameEntity*> m_moved; ///< юниты, смещенные на текущем этапе (ApplyContacts)
+  std::array<PairCounter, EntityTypes::size * EntityTypes::size> m_pair_counters;
+  std::vector<std::pair<unsigned, unsigned>> m_tank_pairs;  ///< номера танков в BoundsCache
+
+  TileMap               m_tile_map;         ///< препятствия, выровненные по клеткам карты
+  std::vector<Barrier*> m_free_barriers;    ///< препятствия вне клеток карты
+  std::vector<sf::FloatRect> m_free_bounds; ///< области m_free_barriers (препятствия неподвижны)
 };
 
 
@@ -70,29 +316,59 @@ void combination(ForwardIt1 first1, ForwardIt1 last1,
   }
 }
 
-/// \ingroup interaction_processing_algorithms
-/// \brief ќсуществл¤ет все парные взаимодействи¤ юнитов одного типа
-/// \tparam T1 должен использовать в качестве фабрики класс Factory и 
-///    определ¤ть перегрузку функции EntityInteraction
-template <typename T1>
-void SingleTipeCombine() {
-  void(*fun_inter)(T1&, T1&) = EntityInteraction;
-  unique_combination(T1::factory::s_current_set.begin(),
-                     T1::factory::s_current_set.end(),
-                     fun_inter);
+template <typename T1, typename T2, typename BinaryOperation>
+void FactoryCombine(SlotMap<T1>& set1, SlotMap<T2>&, BinaryOperation Operation, std::true_type) {
+  unique_combination(set1.begin(), set1.end(), Operation);
+}
+
+template <typename T1, typename T2, typename BinaryOperation>
+void FactoryCombine(SlotMap<T1>& set1, SlotMap<T2>& set2, BinaryOperation Operation,
+                    std::false_type) {
+  combination(set1.begin(), set1.end(), set2.begin(), set2.end(), Operation);
 }
 
 /// \ingroup interaction_processing_algorithms
-/// \brief ќсуществл¤ет все парные взаимодействи¤ юнитов разных типов
-/// \tparam T1,T2 должны использовать в качестве фабрики класс Factory и 
-///   определ¤ть перегрузку функции EntityInteraction(T1, T2)
+/// \brief BinaryOperation(T1&, T2&) вызывается для пар экземпляров из хранилищ Factory:
+/// для одного типа - по правилам unique_combination, для разных - combination
+/// \tparam T1,T2 должны использовать в качестве фабрики класс Factory
+template <typename T1, typename T2, typename BinaryOperation>
+void FactoryCombine(SlotMap<T1>& set1, SlotMap<T2>& set2, BinaryOperation Operation) {
+  FactoryCombine(set1, set2, Operation, std::is_same<T1, T2>());
+}
+
+template <typename T1, typename T2>
+void EntityManager::AddContact(T1& first, const sf::FloatRect& first_bounds,
+                               T2& second, const sf::FloatRect& second_bounds,
+                               unsigned x, unsigned y, bool tile) {
+  m_contacts.push_back({ &first, &second, first_bounds, second_bounds, PairIndex<T1, T2>(),
+                         &TestPair<T1, T2>, &RetestPair<T1, T2>, &ApplyPair<T1, T2>,
+                         x, y, tile, false, 0 });
+}
+
 template <typename T1, typename T2>
-void DoubleTypeCombine() {
-  void(*fun_inter)(T1&, T2&) = EntityInteraction;
-  combination(T1::factory::s_current_set.begin(),
-              T1::factory::s_current_set.end(),
-              T2::factory::s_current_set.begin(),
-              T2::factory::s_current_set.end(),
-              fun_inter);
+void EntityManager::TestPair(Contact& c) {
+  c.hit = NarrowTest(static_cast<const T1&>(*c.first), c.first_bounds,
+                     static_cast<const T2&>(*c.second), c.second_bounds, c.toi);
 }
 
+template <typename T1, typename T2>
+void EntityManager::RetestPair(Contact& c) {
+  const T1& first = static_cast<const T1&>(*c.first);
+  const T2& second = static_cast<const T2&>(*c.second);
+  c.hit = NarrowTest(first, NarrowBounds(first, second), second, NarrowBounds(second, first), c.toi);
+}
+
+template <typename T1, typename T2>
+void EntityManager::ApplyPair(Contact& c) {
+  EntityInteraction(static_cast<T1&>(*c.first), static_cast<T2&>(*c.second));
+}
+
+template <typename T1, typename T2>
+void EntityManager::CollectPairs() {
+  auto& set1 = m_world.getFactory<T1>().getCurrentSet();
+  auto& set2 = m_world.getFactory<T2>().getCurrentSet();
+  FactoryCombine(set1, set2, [this](T1& first, T2& second) {
+    if (first.isSleeping() && second.isSleeping()) return;
+    AddContact(first, NarrowBounds(first, second), second, NarrowBounds(second, first));
+  });
+}
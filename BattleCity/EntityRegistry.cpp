@@ -0,0 +1,90 @@
+#include "EntityRegistry.h"
+
+#include <atomic>
+
+namespace {
+  // отметка удаленной ссылки при уплотнении
+  const std::uint8_t kRemoved = 0xFF;
+}
+
+std::uint8_t EntityRegistry::NewTypeTag() {
+  // номера выдаются при первом обращении к типу, возможно из разных потоков
+  static std::atomic<unsigned> count(0);
+  return static_cast<std::uint8_t>(count++);
+}
+
+void EntityRegistry::RegisterType(std::uint8_t type, void* storage,
+                                  Operation release, Operation publish) {
+  if (m_types.size() <= type) m_types.resize(type + 1);
+  m_types[type].storage = storage;
+  m_types[type].release = release;
+  m_types[type].publish = publish;
+}
+
+std::uint32_t& EntityRegistry::Position(EntityHandle handle) {
+  if (m_position.size() <= handle.type) m_position.resize(handle.type + 1);
+  std::vector<std::uint32_t>& positions = m_position[handle.type];
+  if (positions.size() <= handle.index) positions.resize(handle.index + 1);
+  return positions[handle.index];
+}
+
+void EntityRegistry::Stage(EntityHandle handle) {
+  m_staged.push_back(handle);
+}
+
+void EntityRegistry::Reserve(std::size_t count) {
+  m_staged.reserve(m_staged.size() + count);
+  m_handles.reserve(m_handles.size() + m_staged.size() + count);
+}
+
+void EntityRegistry::Destroy(EntityHandle handle) {
+  m_destroyed.push_back(handle);
+}
+
+void EntityRegistry::Defer(std::function<void()> command) {
+  m_commands.push_back(std::move(command));
+}
+
+void EntityRegistry::Flush() {
+  // команды могут создавать и уничтожать экземпляры, записывая новые команды
+  for (std::size_t i = 0; i < m_commands.size(); ++i) {
+    std::function<void()> command = std::move(m_commands[i]);
+    command();
+  }
+  m_commands.clear();
+
+  if (!m_destroyed.empty()) {
+    for (const EntityHandle& handle : m_destroyed) {
+      EntityHandle& item = m_handles[Position(handle)];
+      if (item.type == kRemoved) continue;        // повторная запись
+      item.type = kRemoved;
+      Release(handle);
+    }
+    m_destroyed.clear();
+    // один проход уплотнения с сохранением порядка оставшихся ссылок
+    std::uint32_t last = 0;
+    for (std::uint32_t pos = 0; pos < m_handles.size(); ++pos) {
+      if (m_handles[pos].type == kRemoved) continue;
+      m_handles[last] = m_handles[pos];
+      Position(m_handles[last]) = last;
+      ++last;
+    }
+    m_handles.resize(last);
+  }
+
+  for (const EntityHandle& handle : m_staged) {
+    Publish(handle);
+    Position(handle) = static_cast<std::uint32_t>(m_handles.size());
+    m_handles.push_back(handle);
+  }
+  m_staged.clear();
+}
+
+void EntityRegistry::clear() {
+  for (const EntityHandle& handle : m_handles) Release(handle);
+  for (const EntityHandle& handle : m_staged) Release(handle);
+  m_handles.clear();
+  m_staged.clear();
+  m_destroyed.clear();
+  m_commands.clear();
+}
@@ -0,0 +1,97 @@
+/// \file
+/// \ingroup battle_city_game_classes
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+
+/// \brief компактная ссылка на экземпляр: тип и номер ячейки в хранилище типа
+struct EntityHandle {
+  std::uint8_t  type;                 ///< номер типа в реестре (EntityRegistry::RegisterType)
+  std::uint32_t index;                ///< ячейка в Factory::s_current_set
+};
+
+
+/// \brief Реестр всех "живущих" игровых сущностей
+///
+/// Хранит компактные ссылки (EntityHandle) в непрерывном массиве и помнит позицию
+/// каждой ссылки по типу и ячейке.
+/// Экземпляр удаляется из хранилища своего типа процедурами, которые хранилище
+/// регистрирует в реестре своего мира при создании (Factory::Factory).
+/// Обновление и отображение выполняются проходами по хранилищам типов
+/// (EntityManager::Update), реестр отвечает за время жизни и общий перебор.
+///
+/// Изменения в ходе шага не применяются сразу, а записываются в очереди команд:
+/// созданные экземпляры (Stage) не участвуют в проходах, удаляемые (Destroy)
+/// остаются на месте, команды при уничтожении (Defer) не вызываются.
+/// Очереди применяются одним пакетом в конце шага (Flush), поэтому проходы по
+/// хранилищам и таблицам не меняются под обрабатывающим их кодом.
+/// \see Factory
+class EntityRegistry {
+ public:
+  /// операции хранилища типа \a storage над экземпляром в ячейке \a index
+  using Operation = void (*)(void* storage, unsigned index);
+
+  /// новый номер типа, общий для реестров всех миров
+  static std::uint8_t NewTypeTag();
+
+  /// регистрирует хранилище типа
+  /// \param type номер типа (NewTypeTag)
+  /// \param storage хранилище экземпляров, передается в операции
+  /// \param release удаляет экземпляр из хранилища
+  /// \param publish включает созданный экземпляр в проходы по хранилищу и таблице
+  void RegisterType(std::uint8_t type, void* storage, Operation release, Operation publish);
+
+  /// записывает созданный экземпляр (включается в реестр при Flush)
+  void Stage(EntityHandle handle);
+
+  /// выделяет память для записи \a count созданных экземпляров и их включения в реестр
+  void Reserve(std::size_t count);
+
+  /// записывает экземпляр на удаление (удаляется при Flush)
+  void Destroy(EntityHandle handle);
+
+  /// записывает команду, вызываемую при Flush
+  void Defer(std::function<void()> command);
+
+  /// \brief применяет записанные изменения:
+  /// вызывает команды (в том числе записанные самими командами), удаляет экземпляры
+  /// с уплотнением массива ссылок, включает созданные экземпляры
+  void Flush();
+
+  /// удаляет все экземпляры, в том числе еще не включенные, и очищает очереди
+  void clear();
+
+  const EntityHandle& operator[](std::size_t pos) const { return m_handles[pos]; }
+  std::size_t size() const { return m_handles.size(); }
+  bool empty() const { return m_handles.empty(); }
+
+ private:
+  struct TypeOps {
+    void*     storage = nullptr;
+    Operation release = nullptr;
+    Operation publish = nullptr;
+  };
+
+  void Release(EntityHandle handle) {
+    const TypeOps& ops = m_types[handle.type];
+    ops.release(ops.storage, handle.index);
+  }
+  void Publish(EntityHandle handle) {
+    const TypeOps& ops = m_types[handle.type];
+    ops.publish(ops.storage, handle.index);
+  }
+
+  std::uint32_t& Position(EntityHandle handle);
+
+  std::vector<TypeOps>      m_types;                    ///< хранилища типов по номеру
+
+  std::vector<EntityHandle> m_handles;
+  std::vector<std::vector<std::uint32_t>> m_position;   ///< [тип][ячейка] -> позиция ссылки
+
+  std::vector<EntityHandle>          m_staged;           ///< созданные на текущем шаге
+  std::vector<EntityHandle>          m_destroyed;        ///< удаляемые в конце шага
+  std::vector<std::function<void()>> m_commands;         ///< отложенные команды
+};
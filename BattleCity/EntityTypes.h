@@ -0,0 +1,149 @@
+/// \file
+/// \ingroup battle_city_game_classes
+#pragma once
+
+#include <string>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+#include "EntityBase.h"
+#include "Units.h"
+
+
+/// \brief список типов, передаваемый как значение в алгоритмы перебора
+template <typename... Ts>
+struct TypeList {
+  static constexpr std::size_t size = sizeof...(Ts);
+};
+
+/// \brief метка типа для обобщенных лямбда-выражений
+template <typename T>
+struct TypeTag {
+  using type = T;
+};
+
+/// \brief Реестр игровых сущностей
+///
+/// Единственное место, где перечисляются наследники GameEntity, хранящиеся в Factory.
+/// По реестру на этапе компиляции строятся матрица взаимодействий
+/// (EntityManager::Interaction), хранилища мира (World) и вывод статистики
+/// (printEntityStatistics).
+/// Для нового типа достаточно добавить его в список, объявить перегрузки
+/// EntityInteraction и, при необходимости, этап (InteractionStage) и
+/// алгоритм отбора пар (EntityManager::CollectPairs).
+using EntityTypes = TypeList<Tank, Bullet, Barrier, Bonus>;
+
+
+/// \brief порядок отображения слоев сцены (EntityManager::Capture)
+using DrawLayers = TypeList<Barrier, Bonus, Tank, Bullet>;
+
+
+/// \brief тип перемещается проходом по массивам таблицы (EntityManager::IntegratePass)
+template <typename T> struct IsMoving : std::false_type {};
+template <> struct IsMoving<Tank>   : std::true_type {};
+template <> struct IsMoving<Bullet> : std::true_type {};
+
+
+/// \brief имя типа сущности для вывода статистики
+template <typename T> struct EntityName;
+template <> struct EntityName<Tank>    { static const char* get() { return "tanks"; } };
+template <> struct EntityName<Bullet>  { static const char* get() { return "bullets"; } };
+template <> struct EntityName<Barrier> { static const char* get() { return "barriers"; } };
+template <> struct EntityName<Bonus>   { static const char* get() { return "bonus"; } };
+
+
+/// \brief порядковый номер типа T в списке
+template <typename T, typename List>
+struct TypeIndex;
+
+template <typename T, typename... Ts>
+struct TypeIndex<T, TypeList<T, Ts...>> : std::integral_constant<std::size_t, 0> {};
+
+template <typename T, typename U, typename... Ts>
+struct TypeIndex<T, TypeList<U, Ts...>>
+  : std::integral_constant<std::size_t, 1 + TypeIndex<T, TypeList<Ts...>>::value> {};
+
+
+/// \brief номер пары типов (T1, T2) в матрице взаимодействий EntityTypes
+template <typename T1, typename T2>
+constexpr std::size_t PairIndex() {
+  return TypeIndex<T1, EntityTypes>::value * EntityTypes::size + TypeIndex<T2, EntityTypes>::value;
+}
+
+
+template <typename... Ts>
+struct MakeVoid { using type = void; };
+
+/// \brief определена ли перегрузка EntityInteraction(T1&, T2&)
+template <typename T1, typename T2, typename = void>
+struct HasInteraction : std::false_type {};
+
+template <typename T1, typename T2>
+struct HasInteraction<T1, T2, typename MakeVoid<
+    decltype(EntityInteraction(std::declval<T1&>(), std::declval<T2&>()))>::type>
+  : std::true_type {};
+
+
+/// \brief этапы обработки взаимодействий в пределах шага, в порядке выполнения
+/// \see EntityManager::Interaction
+enum class InteractionStage {
+  COLLISION = 0,        ///< столкновения подвижных юнитов друг с другом
+  TERRAIN = 1,          ///< контакты с ландшафтом и бонусами после столкновений
+  SWEPT = 2,            ///< касания снарядов на отрезке перемещения в порядке времени касания
+};
+
+/// \brief этап, на котором обрабатывается пара типов (по умолчанию - InteractionStage::TERRAIN)
+template <typename T1, typename T2>
+struct PairStage
+  : std::integral_constant<InteractionStage, InteractionStage::TERRAIN> {};
+
+template <>
+struct PairStage<Tank, Tank>
+  : std::integral_constant<InteractionStage, InteractionStage::COLLISION> {};
+
+template <typename T>
+struct PairStage<T, Bullet>
+  : std::integral_constant<InteractionStage, InteractionStage::SWEPT> {};
+
+template <typename T>
+struct PairStage<Bullet, T>
+  : std::integral_constant<InteractionStage, InteractionStage::SWEPT> {};
+
+template <>
+struct PairStage<Bullet, Bullet>
+  : std::integral_constant<InteractionStage, InteractionStage::SWEPT> {};
+
+
+/// \ingroup interaction_processing_algorithms
+/// \brief вызывает Operation(TypeTag<T>) для каждого типа списка, в порядке списка
+template <typename... Ts, typename Operation>
+void ForEachType(TypeList<Ts...>, Operation op) {
+  int expand[] = { 0, (op(TypeTag<Ts>()), 0)... };
+  (void)expand;
+}
+
+
+template <typename Operation, typename Tag1, typename Tag2>
+void CallInteractionPair(Operation&, Tag1, Tag2, std::false_type) {}
+
+template <typename Operation, typename Tag1, typename Tag2>
+void CallInteractionPair(Operation& op, Tag1 first, Tag2 second, std::true_type) {
+  op(first, second);
+}
+
+/// \ingroup interaction_processing_algorithms
+/// \brief вызывает Operation(TypeTag<T1>, TypeTag<T2>) для каждой пары типов списка,
+/// для которой объявлена перегрузка EntityInteraction(T1&, T2&).
+/// Пары перебираются построчно по матрице типов.
+template <typename... Ts, typename Operation>
+void ForEachInteractionPair(TypeList<Ts...> list, Operation op) {
+  ForEachType(list, [&op, list](auto first) {
+    ForEachType(list, [&op, first](auto second) {
+      using T1 = typename decltype(first)::type;
+      using T2 = typename decltype(second)::type;
+      CallInteractionPair(op, first, second, HasInteraction<T1, T2>());
+    });
+  });
+}
@@ -153,7 +153,7 @@ void EventManager::LoadBindings()
 {
   std::string delimiter = ":";
   std::ifstream bindings;
-  bindings.open(R"(..\resources\keys.cfg)");
+  bindings.open("../resources/keys.cfg");
   //bindings.open(SharedContext::getFilePath("Keys"));
   if (!bindings.is_open()){
     std::cout << __FUNCTION__ << std::endl;
@@ -0,0 +1,80 @@
+#include "FramePacer.h"
+
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+FramePacer::FramePacer(float fps) {
+  setTargetFps(fps);
+}
+
+
+void FramePacer::setTargetFps(float fps) {
+  m_mode = Mode::TARGET_FPS;
+  m_fps = fps;
+  m_budget = sf::seconds(1.0f / fps);
+  m_deadline = m_clock.getElapsedTime() + m_budget;
+}
+
+
+void FramePacer::setMode(Mode mode) {
+  m_mode = mode;
+  m_deadline = m_clock.getElapsedTime() + m_budget;
+}
+
+
+void FramePacer::EndFrame() {
+  if (m_mode == Mode::TARGET_FPS) Wait();
+  sf::Time now = m_clock.getElapsedTime();
+  Count(now - m_frame_start);
+  m_frame_start = now;
+}
+
+
+void FramePacer::Wait() {
+  sf::Time now = m_clock.getElapsedTime();
+  if (now >= m_deadline) {
+    // кадр не уложился в бюджет: следующий отсчитывается от текущего момента
+    ++m_stat.missed;
+    m_deadline = now + m_budget;
+    return;
+  }
+  if (m_deadline - now > Spin()) sf::sleep(m_deadline - now - Spin());
+  while (m_clock.getElapsedTime() < m_deadline) std::this_thread::yield();
+  m_deadline += m_budget;
+}
+
+
+void FramePacer::Count(sf::Time frame) {
+  double t = frame.asSeconds();
+  ++m_stat.frames;
+  double delta = t - m_stat.mean;
+  m_stat.mean += delta / m_stat.frames;
+  m_m2 += delta * (t - m_stat.mean);
+  m_stat.jitter = std::sqrt(m_m2 / m_stat.frames);
+  m_stat.max = std::max(m_stat.max, t);
+}
+
+
+void FramePacer::ResetStatistics() {
+  m_stat = Statistics();
+  m_m2 = 0;
+  m_frame_start = m_clock.getElapsedTime();
+}
+
+
+void FramePacer::printStatistics(const std::string& label) const {
+#ifdef BATTLE_CITY_ENTITY_STATISTICS
+  std::cout << std::endl << label << std::endl;
+  std::cout << "Frame pacing : " << m_stat << std::endl;
+#else
+  (void)label;
+#endif
+}
+
+
+std::ostream& operator<<(std::ostream& os, const FramePacer::Statistics& stat) {
+  return os << "frames " << stat.frames << ", missed " << stat.missed
+            << ", mean " << stat.mean * 1000 << " ms, jitter " << stat.jitter * 1000
+            << " ms, max " << stat.max * 1000 << " ms";
+}
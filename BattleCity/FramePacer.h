@@ -0,0 +1,78 @@
+/// \file
+/// \ingroup SGML_Game_Book
+#pragma once
+
+#include <string>
+#include <iostream>
+
+#include <SFML/System.hpp>
+
+
+/// \brief Выдерживает длительность кадров и собирает статистику их отклонений
+///
+/// В режиме TARGET_FPS после отображения кадра ожидает только остаток бюджета кадра
+/// (1 / fps), отсчитывая сроки от предыдущего срока, а не от момента вызова, поэтому
+/// ошибки ожидания не накапливаются. Большая часть остатка пропускается sf::sleep,
+/// последние Spin() - активным ожиданием, т.к. точность sf::sleep порядка миллисекунды.
+/// Кадр, не уложившийся в бюджет, не ожидает, а сроки отсчитываются заново.
+/// В режиме VSYNC ожидание выполняет вертикальная синхронизация окна
+/// (Window::SetFramePacing), в режиме UNCAPPED кадры не ограничиваются.
+/// \see Window::EndDraw
+class FramePacer {
+ public:
+  /// способ ограничения частоты кадров
+  enum class Mode {
+    TARGET_FPS,                         ///< бюджет кадра 1 / fps
+    VSYNC,                              ///< вертикальная синхронизация
+    UNCAPPED                            ///< без ограничения
+  };
+
+  /// статистика длительности кадров с последнего сброса
+  struct Statistics {
+    unsigned  frames = 0;               ///< количество кадров
+    unsigned  missed = 0;               ///< кадры, превысившие бюджет
+    double    mean = 0;                 ///< средняя длительность кадра [сек]
+    double    jitter = 0;               ///< среднеквадратичное отклонение длительности [сек]
+    double    max = 0;                  ///< наибольшая длительность кадра [сек]
+  };
+
+  /// частота кадров по умолчанию (меню; битва задает свою, State_Battle::Activate)
+  static constexpr float kDefaultFps = 60;
+
+  /// \param fps частота кадров режима TARGET_FPS
+  explicit FramePacer(float fps = kDefaultFps);
+
+  /// устанавливает режим TARGET_FPS с частотой \a fps
+  void setTargetFps(float fps);
+  void setMode(Mode mode);
+  Mode getMode() const { return m_mode; }
+  float getTargetFps() const { return m_fps; }
+
+  /// \brief завершает кадр: ожидает остаток бюджета (TARGET_FPS) и учитывает
+  /// длительность кадра в статистике
+  void EndFrame();
+
+  const Statistics& getStatistics() const { return m_stat; }
+  void ResetStatistics();
+
+  /// выводит статистику (при определенном BATTLE_CITY_ENTITY_STATISTICS)
+  void printStatistics(const std::string& label) const;
+
+ private:
+  void Wait();
+  void Count(sf::Time frame);
+
+  /// остаток ожидания, выполняемый активно
+  static sf::Time Spin() { return sf::milliseconds(2); }
+
+  Mode      m_mode = Mode::TARGET_FPS;
+  float     m_fps;
+  sf::Time  m_budget;                   ///< длительность кадра
+  sf::Clock m_clock;                    ///< отсчет от начала работы
+  sf::Time  m_deadline;                 ///< срок окончания текущего кадра
+  sf::Time  m_frame_start;              ///< начало текущего кадра
+  Statistics m_stat;
+  double    m_m2 = 0;                   ///< сумма квадратов отклонений (метод Уэлфорда)
+};
+
+std::ostream& operator<<(std::ostream& os, const FramePacer::Statistics& stat);
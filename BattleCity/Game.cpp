@@ -1,12 +1,11 @@
 #include "Game.h"
 
 Game::Game() : 
-  m_context(R"(..\resources\paths.cfg)"),
+  m_context("../resources/paths.cfg"),
   m_window("BattleCity", sf::Vector2u(800, 600)), 
   m_stateManager( &m_context )
 {
   m_clock.restart();
-  srand(time(nullptr));
   m_context.m_wind = &m_window;
   m_context.m_eventManager = m_window.GetEventManager();
   m_stateManager.SwitchTo(StateType::TanksMenu);
@@ -33,7 +32,15 @@ Window* Game::GetWindow() {
 
 void Game::Update() {
   m_window.Update();
-  m_stateManager.Update(m_elapsed);
+  m_accumulator += m_elapsed;
+  int ticks = 0;
+  while (m_accumulator >= kTick && ticks < kMaxTicks) {
+    m_stateManager.Update(kTick);
+    m_accumulator -= kTick;
+    ++ticks;
+  }
+  // после длительной задержки кадра моделирование не наверстывает пропущенное время
+  if (m_accumulator >= kTick) m_accumulator = sf::Time::Zero;
 }
 
 
@@ -16,10 +16,16 @@
 /// режиму, не зависимо от правил последовательности переключения и текущих режимов.
 /// Для обмена данными между режимами (конкретными состояниями) Game агрегирует 
 /// и экземпляр SharedContext.
+///
+/// Режимы обновляются шагами постоянной длительности (kTick): прошедшее между
+/// кадрами время накапливается, и за кадр выполняется столько шагов, сколько в нем
+/// уместилось (не более kMaxTicks, остаток отбрасывается). Поэтому результат
+/// моделирования не зависит от частоты кадров.
 class Game {
  public: 
   Game();
   ~Game();
+  /// обрабатывает события окна и выполняет накопленные шаги моделирования
   void Update();
   void Render();
   void LateUpdate();
@@ -34,6 +40,9 @@ private:
   StateManager m_stateManager;                          
   sf::Clock   m_clock;
   sf::Time    m_elapsed;
+  sf::Time    m_accumulator;                            ///< время, еще не отработанное шагами
+  const sf::Time  kTick = sf::seconds(1.0f / 60);        ///< длительность шага моделирования
+  static const int kMaxTicks = 5;                       ///< наибольшее количество шагов за кадр
   void        RestartClock();                           ///< сброс глобального таймера
 };
 
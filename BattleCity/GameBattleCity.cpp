@@ -1,11 +1,12 @@
 #include "GameBattleCity.h"
 #include "SharedContext.h"
 
-BattleCity::BattleCity() : m_scenario(info_) {
-  Tank::factory::LoadCollection(SharedContext::getFilePath("Tanks"));
-  Bullet::factory::LoadCollection(SharedContext::getFilePath("Bullet"));
-  Barrier::factory::LoadCollection(SharedContext::getFilePath("Barrier"));
-  Bonus::factory::LoadCollection(SharedContext::getFilePath("Bonus"));
+BattleCity::BattleCity(World& world)
+    : m_world(world), m_entity_manager(world), m_scenario(world, info_) {
+  m_world.getFactory<Tank>().LoadCollection(SharedContext::getFilePath("Tanks"));
+  m_world.getFactory<Bullet>().LoadCollection(SharedContext::getFilePath("Bullet"));
+  m_world.getFactory<Barrier>().LoadCollection(SharedContext::getFilePath("Barrier"));
+  m_world.getFactory<Bonus>().LoadCollection(SharedContext::getFilePath("Bonus"));
   SpriteSheetInfo::LoadSpriteSheetInfo(SharedContext::getFilePath("SpriteSheet"));
   
   for (auto item : SpriteSheetInfo::s_collection) {
@@ -18,43 +19,70 @@ void BattleCity::Update(const sf::Time& time) {
   if (m_scenario.isGameOver()) {
     info_.geme_over_flag = true;
   }
-  m_entity_manager.Update(m_clock.getElapsedTime());
+  m_time += time;
+  m_entity_manager.Update(m_time);
   m_entity_manager.Interaction();
 
-  m_scenario.Update(m_clock.getElapsedTime());
+  m_scenario.Update(m_time);
+  // созданные и уничтоженные за шаг юниты применяются одним пакетом
+  m_entity_manager.ApplyCommands();
 }
 
 
-void BattleCity::Draw(sf::RenderWindow& wind) {
-  m_entity_manager.Draw(wind);
+void BattleCity::Capture(BattleSnapshot& snapshot, const sf::Time& time) {
+  snapshot.scene.Clear();
+  m_entity_manager.Capture(snapshot.scene);
+  snapshot.field_origin = m_field_origin;
+  snapshot.lives = info_.lives;
+  snapshot.enemies = info_.enemies;
+  snapshot.game_over = info_.geme_over_flag;
+  snapshot.tick = time;
+  snapshot.time = BattleSnapshot::Clock::now();
+}
+
+
+void BattleSnapshot::Draw(sf::RenderWindow& wind) {
+  float alpha = 1;
+  if (tick > sf::Time::Zero) {
+    std::chrono::duration<float> elapsed = Clock::now() - time;
+    alpha = std::min(elapsed.count() / tick.asSeconds(), 1.0f);
+  }
+  const sf::View view = wind.getView();
+  sf::View field(view);
+  field.move(-field_origin);
+  wind.setView(field);
+  scene.Draw(wind, alpha);
+  wind.setView(view);
 }
 
 
 void BattleCity::Start(const std::string& map_file_name) {
-  printEntityStatistics(__FUNCTION__);
+  printEntityStatistics(m_world, __FUNCTION__);
   info_ = GameInfo();
   LoadMapScheme(map_file_name);
   CreateMapBorders();
+  // препятствия включаются в хранилища до распределения по клеткам
+  m_entity_manager.ApplyCommands();
+  sf::Vector2u cells(unsigned(info_.map_width / info_.block_size.x + 0.5f),
+                    unsigned(info_.map_height / info_.block_size.y + 0.5f));
+  m_entity_manager.BuildTileMap(cells, info_.block_size);
+  // на больших картах отбор через деревья областей не зависит от размеров поля
+  m_entity_manager.setBroadphase(cells.x * cells.y > EntityManager::kGridMaxCells
+                                 ? EntityManager::Broadphase::AABB_TREE
+                                 : EntityManager::Broadphase::GRID);
   m_scenario.Start( );
-  m_clock.restart();
+  m_entity_manager.ApplyCommands();
+  m_time = sf::Time::Zero;
 }
 
 
 void BattleCity::Stop() { 
   m_scenario.Stop();
 
-  GameEntity::g_entity_list.clear();
-  Tank::factory::s_current_set.clear();
-  Bullet::factory::s_current_set.clear();
-  Barrier::factory::s_current_set.clear();
-  Bonus::factory::s_current_set.clear();
+  m_world.Clear();
 
-  Tank::factory::s_collection.clear();
-  Bullet::factory::s_collection.clear();
-  Barrier::factory::s_collection.clear();
-  Bonus::factory::s_collection.clear();
-
-  printEntityStatistics(__FUNCTION__);
+  printEntityStatistics(m_world, __FUNCTION__);
+  m_entity_manager.printPairStatistics(__FUNCTION__);
 }
 
 void BattleCity::Player_up()    { m_scenario.ControlledUnit().Forward(); }
@@ -90,7 +118,7 @@ void BattleCity::LoadMapScheme(const std::string& file) {
 void BattleCity::ConvertMapScheme(const std::vector<std::string>& scheme) {
   using namespace std;
   sf::Vector2f block_sz =
-    Barrier::factory::s_collection.begin()->second.size;
+    m_world.getFactory<Barrier>().getCollection().begin()->size;
 
   // find max column num line
   auto max_str = *max_element(scheme.cbegin(), scheme.cend(), 
@@ -99,6 +127,7 @@ void BattleCity::ConvertMapScheme(const std::vector<std::string>& scheme) {
 
   info_.map_width = max_str.size()*block_sz.y;
   info_.map_height = scheme.size()*block_sz.x;
+  info_.block_size = block_sz;
 
   // считываем содержимое схемы карты и интерпретируем в игровые элементы
   sf::Vector2f cursor = {0,0};
@@ -121,16 +150,13 @@ void BattleCity::ConvertMapScheme(const std::vector<std::string>& scheme) {
   commands.emplace(' ', [ ](sf::Vector2f pos) { // space symbol ignor
     ;}); 
   
+  // препятствия создаются после разбора всей схемы, остальные символы в ней затираются
+  vector<string> barrier_scheme(scheme);
   for (auto& line : scheme) {
     cursor.x = 0;
     for (char item : line) {
-      if (commands.find(item) == commands.end()) {
-        // create barrier element
-        auto tmp = Barrier::factory::Create(item, 0);
-        sf::Vector2f pos = { (cursor.x + 0.5f)*block_sz.x,
-                (cursor.y + 0.5f)*block_sz.y };
-        tmp->setPosition(pos);
-      } else {
+      if (commands.find(item) != commands.end()) {
+        barrier_scheme[size_t(cursor.y)][size_t(cursor.x)] = ' ';
         // create Units
         try {
           commands.at(item)({ cursor.x*block_sz.x,
@@ -145,16 +171,47 @@ void BattleCity::ConvertMapScheme(const std::vector<std::string>& scheme) {
     }
     ++cursor.y;
   }
+  CreateMapBarriers(std::move(barrier_scheme), block_sz);
 
   cout << "\n\nmap load: " << endl;
   //getchar();
 }
 
+void BattleCity::CreateMapBarriers(std::vector<std::string> scheme, sf::Vector2f block) {
+  using namespace std;
+  const char empty = ' ';
+  vector<SpawnRecord> records;
+  for (size_t y = 0; y < scheme.size(); ++y) {
+    for (size_t x = 0; x < scheme[y].size(); ++x) {
+      char type = scheme[y][x];
+      if (type == empty) continue;
+      size_t w = 1, h = 1;
+      if (!Barrier::isDestructible(type)) {
+        // жадное объединение: сначала вдоль строки, затем вниз, пока строки совпадают
+        while (x + w < scheme[y].size() && scheme[y][x + w] == type) ++w;
+        for (; y + h < scheme.size(); ++h) {
+          const string& line = scheme[y + h];
+          if (line.size() < x + w || 
+              count(line.begin() + x, line.begin() + x + w, type) != long(w)) {
+            break;
+          }
+        }
+      }
+      for (size_t j = y; j < y + h; ++j) {
+        fill(scheme[j].begin() + x, scheme[j].begin() + x + w, empty);
+      }
+      SpawnRecord record;
+      record.type = type;
+      record.pos = { (x + w / 2.0f) * block.x, (y + h / 2.0f) * block.y };
+      record.size = { w * block.x, h * block.y };
+      records.push_back(record);
+    }
+  }
+  m_world.getFactory<Barrier>().CreateBatch(records, 0);
+}
+
 void BattleCity::setFieldOrigin(sf::Vector2f pos) {
   m_field_origin = pos;
-  //Animation::s_local = pos;
-  AnimBase::s_local = pos;
-  GameEntity::m_local = pos;
 }
 
 void BattleCity::CreateMapBorders() {
@@ -162,24 +219,16 @@ void BattleCity::CreateMapBorders() {
   const float& m_w = info_.map_width;
   const float& m_h = info_.map_height;
 
-  BarrierTypeInfo hor_border;
-  hor_border.name = "unknown";
-  hor_border.type = 'H';
-  hor_border.health = 1000;
-  hor_border.obstruct_Z_eq_0 = 0;
-  hor_border.obstruct_Z_greater_0 = 0;
-  hor_border.size = { m_w, w_brd };
-  Barrier::factory::s_collection.emplace(hor_border.type, hor_border);
-  
-  BarrierTypeInfo vert_border(hor_border);
-  vert_border.type = 'V';
-  vert_border.size = {w_brd, m_h};
-  Barrier::factory::s_collection.emplace(vert_border.type, vert_border);
-
-  auto left_brd  = Barrier::factory::Create('V', 0);
-  auto right_brd  = Barrier::factory::Create('V', 0);
-  auto top_brd  = Barrier::factory::Create('H', 0);
-  auto down_brd  = Barrier::factory::Create('H', 0);
+  // подтипы границ 'V', 'H' (barrier.cfg) общие для всех карт, размер задается здесь
+  auto left_brd  = m_world.getFactory<Barrier>().Create('V', 0);
+  auto right_brd  = m_world.getFactory<Barrier>().Create('V', 0);
+  auto top_brd  = m_world.getFactory<Barrier>().Create('H', 0);
+  auto down_brd  = m_world.getFactory<Barrier>().Create('H', 0);
+
+  left_brd->setSize({ w_brd, m_h });
+  right_brd->setSize({ w_brd, m_h });
+  top_brd->setSize({ m_w, w_brd });
+  down_brd->setSize({ m_w, w_brd });
 
   left_brd->setPosition({ - w_brd / 2, m_h / 2 });
   right_brd->setPosition({ (m_w + w_brd / 2), m_h / 2 });
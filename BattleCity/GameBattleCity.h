@@ -18,6 +18,7 @@
 #include <stdexcept>
 #include <functional>
 #include <algorithm>
+#include <chrono>
 
 #include "SFML\Graphics.hpp"
 
@@ -27,6 +28,31 @@
 #include "Animating.h"
 #include "GameScenario.h"
 #include "EntityBase.h"
+#include "World.h"
+#include "DrawList.h"
+
+
+/// \brief Неизменяемое после публикации состояние битвы для отображения другим потоком
+///
+/// Заполняется потоком моделирования после каждого шага (BattleCity::Capture) и
+/// передается потоку отображения через TripleBuffer (BattleThread).
+/// \see DrawList
+struct BattleSnapshot {
+  using Clock = std::chrono::steady_clock;
+
+  DrawList      scene;                  ///< изображение юнитов в координатах поля
+  sf::Vector2f  field_origin;           ///< BattleCity::setFieldOrigin
+  int           lives = 0;              ///< оставшиеся жизни игрока
+  int           enemies = 0;            ///< оставшиеся соперники
+  bool          game_over = false;      ///< метка завершения игры
+  sf::Time      tick;                   ///< длительность шага моделирования
+  Clock::time_point time;               ///< момент записи
+
+  /// \brief отображает сцену со смещением начала координат поля, интерполируя подвижные
+  /// юниты по времени, прошедшему после записи (не более шага)
+  void Draw(sf::RenderWindow& window);
+};
+
 
 /// \brief Занимается загрузкой карты и созданием игрового поля,
 ///   загрузкой файлов параметров игровых объектов
@@ -40,17 +66,21 @@
 /// - Сбрасывает состояние игры до исходного при рестарте
 /// - Передает события управления в игровой сценарий
 ///
-/// \note для обновления игры используется собственный экземпляр часов sf::Clock, 
-///    это дает возможность учитывать задержки в операциях на каждом шаге.
+/// \note время битвы - сумма длительностей шагов, переданных в Update, поэтому
+///    ход битвы зависит только от последовательности шагов, а не от частоты кадров.
 class BattleCity {
  public:
   /// при создании экземпляра производится обращение к данным файлов, что может вызывать исключения
   /// имена фалов параметров игровых объектов и их анимаций заданы в коде реализации ( это минус )
-  BattleCity();
+  /// \param world мир битвы, в который загружаются параметры игровых объектов
+  explicit BattleCity(World& world);
     
-  /// \param time глобальное время, непрерывное в ходе работы, с нулем на старте битвы
+  /// \param time длительность шага моделирования (Game::kTick)
   void Update(const sf::Time& time);
-  void Draw(sf::RenderWindow& window);
+
+  /// записывает состояние после последнего шага для отображения другим потоком
+  /// \param time длительность шага моделирования
+  void Capture(BattleSnapshot& snapshot, const sf::Time& time);
 
   /// параметры игровой сцены на текущем шаге
   const GameInfo& getInfo() { return info_; }
@@ -73,19 +103,27 @@ class BattleCity {
   void ConvertMapScheme(const std::vector<std::string>& map_scheme);
 
   /// устанавливает начало системы координат области
-  /// визуализации в начало поля отображения сцены
+  /// визуализации в начало поля отображения сцены.
+  /// Позиции юнитов не зависят от него, смещение применяется при отображении (BattleSnapshot::Draw)
   void setFieldOrigin(sf::Vector2f pos);
 
  private:
   /// создает границы игрового поля, за которые не могу выйти подвижные юниты
   void CreateMapBorders();
 
+  /// \brief создает препятствия по схеме карты (пробел - пустая клетка).
+  /// Прямоугольные участки неразрушаемых препятствий одного подтипа объединяются
+  /// в одно препятствие, разрушаемые (Barrier::isDestructible) создаются поклеточно.
+  /// Все препятствия карты создаются одним пакетом (Factory::CreateBatch).
+  void CreateMapBarriers(std::vector<std::string> scheme, sf::Vector2f block);
+
+  World&        m_world;
   EntityManager m_entity_manager;
   GameInfo      info_;
   GameScenario  m_scenario;
 
   sf::Vector2f m_field_origin;  ///< начало координат поля отображения относительно окна
-  sf::Clock m_clock;
+  sf::Time     m_time;          ///< время битвы, с нулем на старте
 };
 
 void test_game_battle_city();
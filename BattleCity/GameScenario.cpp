@@ -1,7 +1,7 @@
 #include "GameScenario.h"
 
 
-GameScenario::GameScenario(GameInfo& init) : m_info(init)
+GameScenario::GameScenario(World& world, GameInfo& init) : m_world(world), m_info(init)
 { }
 
 void GameScenario::Update(const sf::Time& time) {
@@ -15,13 +15,16 @@ void GameScenario::Update(const sf::Time& time) {
 void GameScenario::Start( ) {
   using namespace std;
   
-  auto main_flag = Bonus::factory::Create('f', 0);
+  auto main_flag = m_world.getFactory<Bonus>().Create('f', 0);
   main_flag->setPosition(m_info.flag_pos);
   auto flag_callback = [this]() {this->CommandGameOver(); };
   main_flag->setDestructionCallback(flag_callback);
 
   CreatePlayer();
 
+  // снаряды всех танков, одновременно находящихся на поле (игрок и по танку на порт)
+  m_world.getFactory<Bullet>().Reserve((m_info.enemy_ports.size() + 1) * Tank::kBulletsMax);
+
   int cnt = 0;
   for (auto item : m_info.enemy_ports) {
     s_free_ports.push_back(cnt);
@@ -36,7 +39,7 @@ void GameScenario::Start( ) {
   m_bonus_effect_map.emplace(m_bonus_id[4], [this]() { this->ApplyBonusHelmet(); });
   m_bonus_effect_map.emplace(m_bonus_id[5], [](   ) { std::cout << "Bonus No define." << std::endl; });
 
-  printEntityStatistics(__FUNCTION__);
+  printEntityStatistics(m_world, __FUNCTION__);
 }
 
 
@@ -44,7 +47,7 @@ void GameScenario::Stop() {
   s_free_ports.clear();
   m_bonus_effect_map.clear();
   m_time_last = 0;
-  printEntityStatistics(__FUNCTION__);
+  printEntityStatistics(m_world, __FUNCTION__);
 }
 
 
@@ -58,10 +61,10 @@ void GameScenario::CreatePlayer( ) {
     CommandGameOver();
     // к удаленному после уничтожения player объекту обращаются внешние методы.
     // их ссылка недействительна сейчас.
-    m_player = Tank::factory::Create('e', m_time_last);
+    m_player = m_world.getFactory<Tank>().Create('e', m_time_last);
   }
   else {
-    m_player = Tank::factory::Create('e', m_time_last);
+    m_player = m_world.getFactory<Tank>().Create('e', m_time_last);
     m_player->setPosition(m_info.player_pos);
     auto callback = [this]()
     {
@@ -81,7 +84,7 @@ void GameScenario::CreateTank(float time) {
     s_free_ports.pop_back();
     // присваевается тип танка - по номеру порта
     char enemy_type = m_enemy_id.at(port_id % m_enemy_id.size());
-    auto tmp = Tank::factory::Create(enemy_type, time);
+    auto tmp = m_world.getFactory<Tank>().Create(enemy_type, time);
 
     tmp->setPosition(m_info.enemy_ports[port_id]);
 
@@ -101,9 +104,10 @@ void GameScenario::CreateTank(float time) {
 
 void GameScenario::CreateBonus(char type) {
   using namespace std;
-  float x = fmod( rand(), m_info.map_width / 2.0 ) + m_info.map_width / 4.0;
-  float y = fmod( rand(), m_info.map_height/ 2.0 ) + m_info.map_height/ 4.0;
-  auto tmp = Bonus::factory::Create( type, 0);
+  Random& random = m_world.getRandom();
+  float x = random.Uniform(m_info.map_width / 4, m_info.map_width * 3 / 4);
+  float y = random.Uniform(m_info.map_height / 4, m_info.map_height * 3 / 4);
+  auto tmp = m_world.getFactory<Bonus>().Create( type, 0);
   tmp->setPosition({ x, y });
   
   try {
@@ -124,24 +128,22 @@ void GameScenario::EnemyDestructionEvents(int id) {
 
 void GameScenario::ApplyBonusClock() {
   std::cout << "ApplyBonusClock()" << std::endl;
-  auto iter = Tank::factory::s_current_set.begin();
-  ++iter;
-  for ( ; iter != Tank::factory::s_current_set.end(); ++iter) {
-    iter->setStateFreeze();
+  const Tank* player = m_player ? m_player.get() : nullptr;
+  for (auto& tank : m_world.getFactory<Tank>().getCurrentSet()) {
+    if (&tank != player) tank.setStateFreeze();
   }
 }
 
 void GameScenario::ApplyBonusBomb() {
-  auto iter = Tank::factory::s_current_set.begin();
-  ++iter;
-  for (; iter != Tank::factory::s_current_set.end(); ++iter) {
-    iter->setStateDestruction();
+  const Tank* player = m_player ? m_player.get() : nullptr;
+  for (auto& tank : m_world.getFactory<Tank>().getCurrentSet()) {
+    if (&tank != player) tank.setStateDestruction();
   }
 }
 
 void GameScenario::ApplyBonusStar() {
   std::cout << "ApplyBonusStar()" << std::endl;
-  printEntityStatistics(__FUNCTION__);
+  printEntityStatistics(m_world, __FUNCTION__);
   //getchar();
 }
 
@@ -156,7 +158,6 @@ void GameScenario::ApplyBonusHelmet() {
 
 void GameScenario::CommandGameOver() {
   m_info.geme_over_flag = true;
-  sf::sleep(sf::seconds(1.5));
 }
 
 
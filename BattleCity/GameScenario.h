@@ -19,6 +19,8 @@
 #include "SFML\Graphics.hpp"
 
 #include "Units.h"
+#include "EntityTypes.h"
+#include "World.h"
 
 /// \brief информация о состоянии игровой сцены
 struct GameInfo {
@@ -27,6 +29,7 @@ struct GameInfo {
   std::vector<sf::Vector2f> enemy_ports;  ///< набор позиций появления соперников
   float   map_height = 0;                 ///< высота игрового поля
   float   map_width = 0;                  ///< ширина игрового поля
+  sf::Vector2f block_size;                ///< размер клетки схемы карты
   int     lives = 1;                      ///< оставшиеся жизни игрока
   int     enemies = 19;                   ///< оставшиеся соперники
   bool    geme_over_flag = false;         ///< метка завершения игры
@@ -43,7 +46,8 @@ struct GameInfo {
 class GameScenario {
  public:
   /// инициализируется стартовыми настройками, загруженными из файла схемы карты
-  GameScenario(GameInfo& init);
+  /// \param world мир, в котором сценарий создает юниты
+  GameScenario(World& world, GameInfo& init);
 
   /// \param time глобальное время битвы
   void Update(const sf::Time& time);
@@ -77,9 +81,11 @@ class GameScenario {
   /// создает бонус заданного типа, в соответствие с файлами настроек
   void CreateBonus(char type);
   
-  /// указатель на соотвтетсвующий элемент в хранилище Tank::iterator::s_current_set
+  /// ссылка на соотвтетсвующий элемент в хранилище танков мира
   Tank::iterator m_player;
 
+  World& m_world;                       ///< мир битвы
+
   /// текущее состояние игры
   GameInfo& m_info;
   
@@ -248,7 +248,7 @@ void test_CharDisplay() {
   using namespace  sf;
   using namespace  std;
 
-    SharedContext(R"(..\resources\paths.cfg)");
+    SharedContext("../resources/paths.cfg");
 
   CharDisplay dsp({ 5, 10 }, {16,32});
   dsp << "he\n\n-";
@@ -0,0 +1,50 @@
+#include "HeadlessGame.h"
+
+#include "SpriteManager.h"
+#include "World.h"
+#include "GameBattleCity.h"
+
+HeadlessGame::HeadlessGame(const std::string& paths_file) : m_context(paths_file) {
+  TextureManager::setHeadless(true);
+}
+
+
+HeadlessGame::Report HeadlessGame::Run(const std::string& map_file, unsigned ticks,
+                                       std::uint64_t seed, sf::Time tick) {
+  std::string file = map_file;
+  if (file.empty()) {
+    m_context.LoadStageList(SharedContext::getFilePath("StageList"));
+    m_context.ResetStage();
+    file = m_context.CurrentStageFile();
+  }
+
+  World world(seed);
+  BattleCity battle(world);
+  battle.Start(file);
+
+  Report report;
+  report.seed = seed;
+  sf::Clock clock;
+  while (report.ticks < ticks && !battle.getInfo().geme_over_flag) {
+    battle.Update(tick);
+    ++report.ticks;
+  }
+  report.seconds = clock.getElapsedTime().asSeconds();
+  report.battle_time = report.ticks * tick.asSeconds();
+  report.game_over = battle.getInfo().geme_over_flag;
+  report.lives = battle.getInfo().lives;
+  report.enemies = battle.getInfo().enemies;
+
+  battle.Stop();
+  return report;
+}
+
+
+std::ostream& operator<<(std::ostream& os, const HeadlessGame::Report& report) {
+  return os << "seed " << report.seed << ", ticks " << report.ticks
+            << " in " << report.seconds << " s ("
+            << report.TicksPerSecond() << " ticks/s), battle time "
+            << report.battle_time << " s, lives " << report.lives
+            << ", enemies " << report.enemies
+            << (report.game_over ? ", game over" : "");
+}
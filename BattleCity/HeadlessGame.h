@@ -0,0 +1,58 @@
+/// \file
+/// \ingroup SGML_Game_Book
+#pragma once
+
+#include <string>
+#include <iostream>
+#include <cstdint>
+
+#include <SFML/System.hpp>
+
+#include "SharedContext.h"
+#include "Random.h"
+
+
+/// \brief запускает битву без графического окна и текстур
+///
+/// В отличие от Game, не создает Window и режимы программы: модель битвы
+/// (BattleCity, GameScenario, EntityManager) обновляется шагами постоянной длительности
+/// подряд, без ожидания реального времени, и не отображается.
+/// Файлы текстур не загружаются (TextureManager::setHeadless), спрайты и анимации
+/// создаются с пустой текстурой, поэтому графическое окружение ОС не требуется.
+/// Предназначен для серверов, ботов и измерения производительности моделирования.
+/// Прогоны с одинаковыми картой, зерном и количеством шагов дают одинаковый результат
+/// (World::getRandom).
+/// \see main
+class HeadlessGame {
+ public:
+  /// результат прогона битвы
+  struct Report {
+    std::uint64_t seed = 0;             ///< зерно генератора случайных чисел мира
+    unsigned  ticks = 0;                ///< выполненные шаги моделирования
+    double    seconds = 0;              ///< реальное время прогона [сек]
+    float     battle_time = 0;          ///< время битвы [сек]
+    bool      game_over = false;        ///< битва завершилась до исчерпания шагов
+    int       lives = 0;                ///< оставшиеся жизни игрока
+    int       enemies = 0;              ///< оставшиеся соперники
+
+    /// шагов моделирования в секунду реального времени
+    double TicksPerSecond() const { return seconds > 0 ? ticks / seconds : 0; }
+  };
+
+  /// \param paths_file файл путей к файлам данных (SharedContext)
+  explicit HeadlessGame(const std::string& paths_file);
+
+  /// \brief проводит битву
+  /// \param map_file файл схемы карты (пустая строка - первый уровень списка StageList)
+  /// \param ticks наибольшее количество шагов моделирования
+  /// \param seed зерно генератора случайных чисел мира
+  /// \param tick длительность шага моделирования (как в Game)
+  Report Run(const std::string& map_file, unsigned ticks,
+             std::uint64_t seed = Random::kDefaultSeed,
+             sf::Time tick = sf::seconds(1.0f / 60));
+
+ private:
+  SharedContext m_context;              ///< пути к файлам данных и список уровней
+};
+
+std::ostream& operator<<(std::ostream& os, const HeadlessGame::Report& report);
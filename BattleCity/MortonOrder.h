@@ -0,0 +1,111 @@
+/// \file
+/// \ingroup interaction_processing_algorithms
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cstdint>
+
+#include <SFML\Graphics.hpp>
+
+#include "Components.h"
+
+
+/// \ingroup interaction_processing_algorithms
+/// \brief разносит 16 младших битов \a v по четным позициям
+inline std::uint32_t MortonSpread(std::uint32_t v) {
+  v &= 0xFFFF;
+  v = (v | (v << 8)) & 0x00FF00FF;
+  v = (v | (v << 4)) & 0x0F0F0F0F;
+  v = (v | (v << 2)) & 0x33333333;
+  v = (v | (v << 1)) & 0x55555555;
+  return v;
+}
+
+/// \ingroup interaction_processing_algorithms
+/// \brief ключ Z-порядка (Morton) клетки, в которой лежит точка \a pos.
+/// Клетки вне поля (границы с отрицательными координатами) прижимаются к краю.
+/// \param cell размер клетки
+inline std::uint32_t MortonKey(sf::Vector2f pos, sf::Vector2f cell) {
+  float fx = std::min(std::max(pos.x / cell.x, 0.0f), 65535.0f);
+  float fy = std::min(std::max(pos.y / cell.y, 0.0f), 65535.0f);
+  return MortonSpread(std::uint32_t(fx)) | (MortonSpread(std::uint32_t(fy)) << 1);
+}
+
+
+/// \ingroup interaction_processing_algorithms
+/// \brief Упорядочивает строки ComponentTable по Z-порядку клеток их позиций
+/// \tparam T тип игровой сущности
+///
+/// Соседние на поле юниты оказываются рядом в массивах таблицы, поэтому проходы
+/// по строкам (BoundsCache::Fill, EntityManager::CapturePass) и запросы к областям
+/// соседей обращаются к близким участкам памяти.
+/// Экземпляры при этом не перемещаются: меняются только номера их строк.
+///
+/// Полная сортировка (Sort) выполняется для неподвижных юнитов после построения карты.
+/// Для подвижных на каждом шаге выполняется частичная сортировка вставками (Step)
+/// с ограниченным числом перестановок: между шагами юниты смещаются мало, порядок
+/// почти сохраняется, и проход сводится к вычислению ключей.
+/// \see ComponentTable::SwapRows, EntityManager::Interaction
+template <typename T>
+class MortonOrder {
+ public:
+  /// полностью упорядочивает строки таблицы
+  /// \param cell размер клетки
+  void Sort(ComponentTable<T>& table, sf::Vector2f cell) {
+    std::size_t n = table.getRowsNum();
+    ComputeKeys(table, cell);
+    m_order.resize(n);
+    std::iota(m_order.begin(), m_order.end(), 0u);
+    std::stable_sort(m_order.begin(), m_order.end(),
+      [this](unsigned a, unsigned b) { return m_keys[a] < m_keys[b]; });
+    // перестановка строк по циклам: строка m_order[k] переносится на место k
+    m_where.resize(n);
+    m_at.resize(n);
+    std::iota(m_where.begin(), m_where.end(), 0u);
+    std::iota(m_at.begin(), m_at.end(), 0u);
+    for (unsigned k = 0; k < n; ++k) {
+      unsigned row = m_order[k];
+      unsigned from = m_where[row];
+      if (from == k) continue;
+      table.SwapRows(k, from);
+      unsigned moved = m_at[k];
+      m_where[moved] = from;
+      m_at[from] = moved;
+      m_where[row] = k;
+      m_at[k] = row;
+    }
+  }
+
+  /// \brief частичная сортировка вставками
+  /// \param cell размер клетки
+  /// \param budget наибольшее количество перестановок соседних строк за вызов
+  /// \return выполненные перестановки (меньше \a budget - таблица упорядочена)
+  unsigned Step(ComponentTable<T>& table, sf::Vector2f cell, unsigned budget) {
+    ComputeKeys(table, cell);
+    unsigned swaps = 0;
+    for (unsigned i = 1; i < m_keys.size(); ++i) {
+      for (unsigned j = i; j > 0 && m_keys[j - 1] > m_keys[j]; --j) {
+        if (swaps == budget) return swaps;
+        std::swap(m_keys[j - 1], m_keys[j]);
+        table.SwapRows(j - 1, j);
+        ++swaps;
+      }
+    }
+    return swaps;
+  }
+
+ private:
+  void ComputeKeys(const ComponentTable<T>& table, sf::Vector2f cell) {
+    m_keys.resize(table.getRowsNum());
+    for (unsigned row = 0; row < m_keys.size(); ++row) {
+      m_keys[row] = MortonKey(table.pos[row], cell);
+    }
+  }
+
+  std::vector<std::uint32_t> m_keys;      ///< ключи строк таблицы
+  std::vector<unsigned>      m_order;     ///< строки в порядке ключей (Sort)
+  std::vector<unsigned>      m_where;     ///< текущая позиция исходной строки (Sort)
+  std::vector<unsigned>      m_at;        ///< исходная строка на позиции (Sort)
+};
@@ -0,0 +1,78 @@
+/// \file
+/// \ingroup battle_city_game_classes
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+
+/// \brief Генератор псевдослучайных чисел мира (xoshiro128**)
+///
+/// Состояние генератора (128 бит) принадлежит миру (World::getRandom), поэтому
+/// последовательность не зависит от других миров и от глобального rand().
+/// Одинаковое зерно и одинаковые команды управления воспроизводят битву точно:
+/// на этом основаны повторы, сетевая игра с синхронными шагами и сравнение
+/// производительности на одинаковых битвах.
+/// Зерно разворачивается в состояние генератором splitmix64, поэтому допустимо любое
+/// значение, включая 0. Удовлетворяет требованиям UniformRandomBitGenerator.
+class Random {
+ public:
+  using result_type = std::uint32_t;
+
+  /// зерно по умолчанию
+  static constexpr std::uint64_t kDefaultSeed = 0x42C17Bu;
+
+  explicit Random(std::uint64_t seed = kDefaultSeed) { Seed(seed); }
+
+  /// начинает последовательность, определенную зерном \a seed
+  void Seed(std::uint64_t seed) {
+    m_seed = seed;
+    std::uint64_t x = seed;
+    for (int i = 0; i < 4; i += 2) {
+      std::uint64_t z = SplitMix(x);
+      m_s[i] = std::uint32_t(z);
+      m_s[i + 1] = std::uint32_t(z >> 32);
+    }
+  }
+  std::uint64_t getSeed() const { return m_seed; }
+
+  /// очередное число [0, 2^32)
+  result_type operator()() {
+    const std::uint32_t result = Rotl(m_s[1] * 5, 7) * 9;
+    const std::uint32_t t = m_s[1] << 9;
+    m_s[2] ^= m_s[0];
+    m_s[3] ^= m_s[2];
+    m_s[1] ^= m_s[2];
+    m_s[0] ^= m_s[3];
+    m_s[2] ^= t;
+    m_s[3] = Rotl(m_s[3], 11);
+    return result;
+  }
+
+  /// равномерно распределенное целое [0, n), n > 0 (умножение со сдвигом, без деления)
+  std::uint32_t Uniform(std::uint32_t n) {
+    return std::uint32_t((std::uint64_t((*this)()) * n) >> 32);
+  }
+
+  /// равномерно распределенное число [a, b)
+  float Uniform(float a, float b) {
+    // старшие 24 бита - точно представимая в float доля [0, 1)
+    return a + (b - a) * (((*this)() >> 8) * (1.0f / 16777216.0f));
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+ private:
+  static std::uint32_t Rotl(std::uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+  static std::uint64_t SplitMix(std::uint64_t& x) {
+    std::uint64_t z = (x += 0x9E3779B97F4A7C15u);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+    return z ^ (z >> 31);
+  }
+
+  std::uint32_t m_s[4];                   ///< состояние генератора
+  std::uint64_t m_seed;                   ///< зерно текущей последовательности
+};
@@ -3,7 +3,7 @@
 SharedContext::PathsMap SharedContext::m_paths_map;
 
 SharedContext::SharedContext(const std::string & paths_file) : m_wind(nullptr), m_eventManager(nullptr) {
-  LoadConfigFiles(paths_file);
+  LoadConfigFiles(PortablePath(paths_file));
 }
 
 
@@ -47,7 +47,7 @@ void SharedContext::LoadConfigFiles(const std::string & filename) {
     if (line[0] == '#') continue;
     istringstream is(line);
     if (is >> file >> path) {
-      m_paths_map.emplace(file, path);
+      m_paths_map.emplace(file, PortablePath(path));
     }
     else {
       cout << __FUNCTION__ << " : can't read line : "  << line;
@@ -83,7 +83,7 @@ void SharedContext::LoadStageList(const std::string & filename) {
     istringstream is(line);
     if (is >> stage_name >> stage_file) {
       map_list.push_back(make_pair(
-        std::move(stage_name), std::move(stage_file)));
+        std::move(stage_name), PortablePath(std::move(stage_file))));
     }
     else {
       cout << __FUNCTION__ << " : can't read line : "
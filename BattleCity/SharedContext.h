@@ -3,6 +3,7 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <algorithm>
 #include <utility>
 #include <unordered_map>
 
@@ -43,7 +44,7 @@ class SharedContext {
   /// Пример содержимого файла:
   ///     # level map list
   ///     # stage_name| failename.map
-  ///     stage-first    ..\resources\stage1.map
+  ///     stage-first    ../resources/stage1.map
   ///     ...
   void LoadStageList(const std::string & );
   
@@ -82,6 +83,13 @@ class SharedContext {
   /// \param name идентификационное имя фала данных
   static const std::string& getFilePath(const std::string& name);
 
+  /// \brief заменяет разделители '\\' путей файлов данных на '/'.
+  /// Такие пути открываются и в Windows, и в POSIX (BattleCity --headless на сервере)
+  static std::string PortablePath(std::string path) {
+    std::replace(path.begin(), path.end(), '\\', '/');
+    return path;
+  }
+
 private:
   StageList map_list;
   /// курсор передвижений по списку уровней
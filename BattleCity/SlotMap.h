@@ -0,0 +1,254 @@
+/// \file
+/// \ingroup battle_city_game_classes
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <stdexcept>
+
+
+/// \brief Хранилище экземпляров с постоянными адресами и поколениями ячеек
+/// \tparam T тип хранимых объектов
+///
+/// Объекты размещаются в ячейках блоков фиксированного размера (kChunk), блоки
+/// не перемещаются, поэтому адрес объекта постоянен все время его жизни (на объекты
+/// ссылаются стратегии поведения, сетки и деревья отбора пар).
+/// Освобожденные ячейки образуют список свободных и занимаются повторно, поэтому
+/// создание и удаление выполняются за O(1) и после заполнения блоков не обращаются
+/// к распределителю памяти. Перебор - линейный проход по ячейкам блоков с пропуском
+/// свободных.
+///
+/// При освобождении ячейки увеличивается ее поколение. Handle хранит номер ячейки и
+/// поколение на момент создания объекта, поэтому обращение через Handle к удаленному
+/// объекту (в том числе, если ячейка уже занята другим) обнаруживается.
+/// \see Factory
+template <typename T>
+class SlotMap {
+  struct Slot;
+
+ public:
+  static const unsigned kChunk = 64;            ///< количество ячеек в блоке
+
+  /// \brief устойчивая ссылка на объект хранилища
+  ///
+  /// Остается действительной, пока объект не удален. Обращение к удаленному объекту
+  /// приводит к исключению std::invalid_argument.
+  class Handle {
+   public:
+    Handle() = default;
+
+    /// объект еще существует
+    bool isValid() const {
+      return m_map && m_map->isAlive(m_index, m_generation);
+    }
+    explicit operator bool() const { return isValid(); }
+
+    T& operator*() const  { return *get(); }
+    T* operator->() const { return get(); }
+
+    /// указатель на объект
+    /// \throw std::invalid_argument объект удален
+    T* get() const {
+      if (!isValid()) {
+        std::cout << "SlotMap::Handle : access to removed entity" << std::endl;
+        throw std::invalid_argument("stale entity handle");
+      }
+      return m_map->slot(m_index).object();
+    }
+
+    unsigned getIndex() const { return m_index; }
+
+    bool operator==(const Handle& other) const {
+      return m_map == other.m_map && m_index == other.m_index &&
+             m_generation == other.m_generation;
+    }
+    bool operator!=(const Handle& other) const { return !(*this == other); }
+
+   private:
+    friend class SlotMap;
+    Handle(SlotMap* map, unsigned index, unsigned generation)
+      : m_map(map), m_index(index), m_generation(generation) {}
+
+    SlotMap*  m_map = nullptr;
+    unsigned  m_index = 0;
+    unsigned  m_generation = 0;
+  };
+
+  /// \brief последовательный перебор существующих объектов в порядке ячеек
+  ///
+  /// Отложенные объекты (emplace_with с \a staged) пропускаются до Publish.
+  /// Перебор ограничен ячейками, занятыми на момент вызова begin(): объекты, созданные
+  /// в новых ячейках во время перебора, не посещаются.
+  template <bool Const>
+  class Iterator {
+    using Map = typename std::conditional<Const, const SlotMap, SlotMap>::type;
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = typename std::conditional<Const, const T*, T*>::type;
+    using reference         = typename std::conditional<Const, const T&, T&>::type;
+
+    Iterator() = default;
+    Iterator(Map* map, unsigned index)
+      : m_map(map), m_index(index), m_limit(map->m_size) { Skip(); }
+
+    reference operator*() const  { return *m_map->slot(m_index).object(); }
+    pointer   operator->() const { return m_map->slot(m_index).object(); }
+
+    Iterator& operator++() {
+      ++m_index;
+      Skip();
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
+    bool operator==(const Iterator& other) const { return m_index == other.m_index; }
+    bool operator!=(const Iterator& other) const { return m_index != other.m_index; }
+
+    /// устойчивая ссылка на текущий объект
+    Handle getHandle() const { return m_map->getHandle(m_index); }
+
+    /// ячейка текущего объекта
+    unsigned getIndex() const { return m_index; }
+
+   private:
+    void Skip() {
+      while (m_index < m_limit && !m_map->slot(m_index).isVisible()) ++m_index;
+    }
+    Map*      m_map = nullptr;
+    unsigned  m_index = 0;
+    unsigned  m_limit = 0;                      ///< граница перебора
+  };
+
+  using iterator       = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  SlotMap() = default;
+  SlotMap(const SlotMap&) = delete;
+  SlotMap& operator=(const SlotMap&) = delete;
+  ~SlotMap() { clear(); }
+
+  /// \brief создает объект в свободной ячейке
+  /// \param args аргументы конструктора T
+  template <typename... Args>
+  Handle emplace(Args&&... args) {
+    return emplace_with([&](void* place) {
+      ::new (place) T(std::forward<Args>(args)...);
+    });
+  }
+
+  /// \brief создает объект в свободной ячейке функцией Construct(void* place),
+  /// размещающей новый объект T по адресу place.
+  /// Используется, если конструктор T доступен только вызывающему (Factory::Create).
+  /// \param staged объект доступен по Handle, но не перебирается до вызова Publish
+  template <typename Construct>
+  Handle emplace_with(Construct construct, bool staged = false) {
+    unsigned index = Acquire();
+    Slot& s = slot(index);
+    try {
+      construct(static_cast<void*>(&s.storage));
+    }
+    catch (...) {
+      s.next_free = m_free;
+      m_free = index;
+      throw;
+    }
+    s.alive = true;
+    s.staged = staged;
+    ++m_alive;
+    return Handle(this, index, s.generation);
+  }
+
+  /// удаляет объект ячейки \a index (ячейка становится свободной)
+  void erase(unsigned index) {
+    Slot& s = slot(index);
+    if (!s.alive) return;
+    s.alive = false;
+    ++s.generation;
+    --m_alive;
+    s.object()->~T();
+    s.next_free = m_free;
+    m_free = index;
+  }
+
+  /// включает отложенный объект ячейки \a index в перебор
+  void Publish(unsigned index) { slot(index).staged = false; }
+
+  /// \brief заранее выделяет блоки не менее чем для \a count ячеек.
+  /// Пока количество объектов не превышает \a count, создание не обращается
+  /// к распределителю памяти.
+  void reserve(std::size_t count) {
+    while (m_chunks.size() * kChunk < count) m_chunks.emplace_back(new Slot[kChunk]);
+  }
+
+  /// удаляет все объекты, сохраняя блоки и поколения ячеек
+  void clear() {
+    for (unsigned i = 0; i < m_size; ++i) erase(i);
+  }
+
+  Handle getHandle(unsigned index) { return Handle(this, index, slot(index).generation); }
+
+  /// объект ячейки \a index (без проверки поколения)
+  T& operator[](unsigned index) { return *slot(index).object(); }
+  const T& operator[](unsigned index) const { return *slot(index).object(); }
+
+  iterator begin()             { return iterator(this, 0); }
+  iterator end()               { return iterator(this, m_size); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end()   const { return const_iterator(this, m_size); }
+
+  /// количество существующих объектов
+  std::size_t size() const { return m_alive; }
+  bool empty() const { return m_alive == 0; }
+
+ private:
+  struct Slot {
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    unsigned  generation = 0;                 ///< увеличивается при каждом освобождении
+    unsigned  next_free = 0;                  ///< следующая свободная ячейка
+    bool      alive = false;
+    bool      staged = false;                 ///< создан, но еще не включен в перебор
+
+    bool isVisible() const { return alive && !staged; }
+
+    T* object() { return reinterpret_cast<T*>(&storage); }
+    const T* object() const { return reinterpret_cast<const T*>(&storage); }
+  };
+
+  Slot& slot(unsigned index) { return m_chunks[index / kChunk][index % kChunk]; }
+  const Slot& slot(unsigned index) const { return m_chunks[index / kChunk][index % kChunk]; }
+
+  bool isAlive(unsigned index, unsigned generation) const {
+    if (index >= m_size) return false;
+    const Slot& s = slot(index);
+    return s.alive && s.generation == generation;
+  }
+
+  /// свободная ячейка: из списка освобожденных или следующая в последнем блоке
+  unsigned Acquire() {
+    if (m_free != kNone) {
+      unsigned index = m_free;
+      m_free = slot(index).next_free;
+      return index;
+    }
+    if (m_size == m_chunks.size() * kChunk) {
+      m_chunks.emplace_back(new Slot[kChunk]);
+    }
+    return m_size++;
+  }
+
+  static const unsigned kNone = ~0u;
+
+  std::vector<std::unique_ptr<Slot[]>> m_chunks;   ///< блоки ячеек
+  unsigned  m_size = 0;                           ///< количество использованных ячеек
+  unsigned  m_alive = 0;                          ///< количество существующих объектов
+  unsigned  m_free = kNone;                       ///< первая свободная ячейка
+};
@@ -0,0 +1,128 @@
+/// \file
+/// \ingroup battle_city_game_classes
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+#include <SFML\Graphics.hpp>
+
+#include "BoundsCache.h"
+
+
+/// \ingroup interaction_processing_algorithms
+/// \brief Равномерная сетка (пространственный хеш) для отбора кандидатов на взаимодействие
+/// \tparam T тип игровой сущности, предоставляющий метод getBounds()
+///
+/// Игровое поле разбивается на квадратные ячейки одинакового размера.
+/// Каждый элемент регистрируется во всех ячейках, которые перекрывает его прямоугольная область.
+/// Запрос по прямоугольной области возвращает только элементы из перекрываемых ячеек,
+/// поэтому стоимость проверки определяется числом соседей, а не размером всего набора.
+///
+/// Сетка перестраивается на каждом шаге (Build). Ячейки хранятся в хеш-таблице,
+/// поэтому отрицательные координаты (границы карты) и элементы крупнее ячейки допустимы.
+/// Емкость ячеек сохраняется между шагами, чтобы не перераспределять память.
+/// \see EntityManager::Interaction, EntityManager::CollectPairs
+template <typename T>
+class SpatialGrid {
+ public:
+  /// \param cell_size сторона ячейки сетки
+  explicit SpatialGrid(float cell_size = 32) : m_cell(cell_size) {}
+
+  /// удаляет все элементы, сохраняя выделенную память ячеек
+  void Clear() {
+    for (auto& cell : m_cells) cell.second.clear();
+    m_items.clear();
+    m_stamps.clear();
+  }
+
+  /// перестраивает сетку по набору элементов, номера элементов соответствуют порядку в наборе
+  template <typename Container>
+  void Build(Container& set) {
+    Clear();
+    for (auto& item : set) Insert(item);
+  }
+
+  /// перестраивает сетку по областям, сохраненным в кэше на текущем шаге
+  void Build(BoundsCache<T>& cache) {
+    Clear();
+    for (unsigned id = 0; id < cache.size(); ++id) Insert(cache[id], cache.getBounds(id));
+  }
+
+  /// регистрирует элемент во всех перекрываемых им ячейках
+  /// \return порядковый номер элемента в сетке
+  unsigned Insert(T& item) { return Insert(item, item.getBounds()); }
+
+  /// регистрирует элемент с заданной областью
+  unsigned Insert(T& item, const sf::FloatRect& rec) {
+    unsigned id = static_cast<unsigned>(m_items.size());
+    m_items.push_back(&item);
+    m_stamps.push_back(0);
+    ForEachCell(rec, [this, id](std::vector<unsigned>& cell) {
+      cell.push_back(id);
+    });
+    return id;
+  }
+
+  /// вызывает Operation(T&, unsigned id) для каждого элемента из ячеек, перекрываемых областью.
+  /// Каждый элемент передается не более одного раза, в порядке регистрации.
+  template <typename Operation>
+  void Query(const sf::FloatRect& rec, Operation op) {
+    ++m_query;
+    m_found.clear();
+    ForEachCell(rec, [this](std::vector<unsigned>& cell) {
+      for (unsigned id : cell) {
+        if (m_stamps[id] == m_query) continue;
+        m_stamps[id] = m_query;
+        m_found.push_back(id);
+      }
+    }, false);
+    std::sort(m_found.begin(), m_found.end());
+    for (unsigned id : m_found) {
+      op(*m_items[id], id);
+    }
+  }
+
+  /// количество зарегистрированных элементов
+  std::size_t size() const { return m_items.size(); }
+
+ private:
+  using CellKey = std::uint64_t;
+  using Cell = std::vector<unsigned>;
+
+  CellKey Key(int x, int y) const {
+    return (CellKey(std::uint32_t(x)) << 32) | CellKey(std::uint32_t(y));
+  }
+
+  /// перебирает ячейки, перекрываемые областью.
+  /// \param create создавать ли отсутствующие ячейки (false - пропускать)
+  template <typename CellOperation>
+  void ForEachCell(const sf::FloatRect& rec, CellOperation op, bool create = true) {
+    int x0 = static_cast<int>(std::floor(rec.left / m_cell));
+    int y0 = static_cast<int>(std::floor(rec.top / m_cell));
+    int x1 = static_cast<int>(std::floor((rec.left + rec.width) / m_cell));
+    int y1 = static_cast<int>(std::floor((rec.top + rec.height) / m_cell));
+    for (int x = x0; x <= x1; ++x) {
+      for (int y = y0; y <= y1; ++y) {
+        if (create) {
+          op(m_cells[Key(x, y)]);
+        }
+        else {
+          auto iter = m_cells.find(Key(x, y));
+          if (iter != m_cells.end()) op(iter->second);
+        }
+      }
+    }
+  }
+
+  std::unordered_map<CellKey, Cell> m_cells;   ///< непустые (и ранее использованные) ячейки
+  std::vector<T*>       m_items;               ///< зарегистрированные элементы
+  std::vector<unsigned> m_stamps;              ///< метка последнего запроса, вернувшего элемент
+  std::vector<unsigned> m_found;               ///< кандидаты текущего запроса
+  unsigned              m_query = 0;           ///< номер текущего запроса
+  float                 m_cell;                ///< сторона ячейки
+};
+
@@ -6,6 +6,9 @@
 #include "SpriteManager.h"
 #include "SharedContext.h"
 
+bool TextureManager::s_headless = false;
+
+
 TextureManager::TextureManager() {
   LoadPaths(SharedContext::getFilePath("Textures"));
   LoadTextures();
@@ -35,7 +38,7 @@ void TextureManager::LoadPaths(const std::string& fileName) {
       keystream >> pathName;
       keystream >> path;
       if (!path.empty() && !pathName.empty()) { // защита от пустых строк 
-        m_paths.emplace(pathName, path);
+        m_paths.emplace(pathName, SharedContext::PortablePath(path));
       }
     }
     paths.close();
@@ -69,6 +72,11 @@ void TextureManager::LoadTextures() {
 
 
 const sf::Texture* TextureManager::Get(const std::string& id_name) {
+  if (s_headless) {
+    // пустая текстура не создает объектов OpenGL и не требует окна
+    static const sf::Texture blank;
+    return &blank;
+  }
   static TextureManager mngr;
   Textures::iterator iter;
   if ((iter = mngr.m_textures.find(id_name)) ==
@@ -193,7 +201,7 @@ void test_TextureManager() {
   sf::CircleShape shape(100.f);
   shape.setFillColor(sf::Color::Green);
 
-    SharedContext(R"(..\resources\paths.cfg)");
+    SharedContext("../resources/paths.cfg");
 
   auto tex1 = TextureManager::Get("Tanks");
   auto tex2 = TextureManager::Get("Exit");
@@ -255,7 +263,7 @@ void test_SpriteManager_createSprite() {
   shape.setFillColor(sf::Color::Green);
 
   //Texture tx = *TextureManager::Get("Tanks");
-    SharedContext(R"(..\resources\paths.cfg)");
+    SharedContext("../resources/paths.cfg");
 
     Sprite sp1 = SpriteManager::Get("main_label");
   Sprite sp2 = SpriteManager::Get("1_player");
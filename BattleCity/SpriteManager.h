@@ -32,6 +32,11 @@ class TextureManager {
   /// \param id_name уникальное имя текстуры
   static const sf::Texture* Get(const std::string& id_name);
 
+  /// \brief режим без графики: файлы текстур не загружаются, Get возвращает пустую
+  /// текстуру. Включается до первого обращения к Get (HeadlessGame)
+  static void setHeadless(bool headless) { s_headless = headless; }
+  static bool isHeadless() { return s_headless; }
+
  private:
   TextureManager();
   ~TextureManager();
@@ -40,6 +45,7 @@ class TextureManager {
 
   TexteresPaths  m_paths;                  ///< набор файлов с текстурами
   Textures    m_textures;                  ///< набор загруженных текстур
+  static bool s_headless;                  ///< режим без графики
 };
 
 
@@ -26,7 +26,8 @@ void State_Battle::OnCreate() {
 
 
 void State_Battle::OnDestroy() {
-  printEntityStatistics(__FUNCTION__);
+  if (m_thread) m_thread->Stop();
+  if (m_world) printEntityStatistics(*m_world, __FUNCTION__);
   //getchar();
 }
 
@@ -34,7 +35,11 @@ void State_Battle::OnDestroy() {
 void State_Battle::Activate() {
   using namespace std;
   //printEntityStatistics(__FUNCTION__);
-  m_battle.reset(new BattleCity);
+  // зерно битвы выводится для воспроизведения (HeadlessGame)
+  std::uint64_t seed = std::uint64_t(std::time(nullptr));
+  cout << "Battle seed : " << seed << endl;
+  m_world.reset(new World(seed));
+  m_battle.reset(new BattleCity(*m_world));
   m_panel.reset(new InfoPanel({16,16}));
   // загрузка карты и инициализация
   m_battle->Start(m_stateMgr->GetContext()->CurrentStageFile());
@@ -45,12 +50,24 @@ void State_Battle::Activate() {
   m_bkg.setFillColor(sf::Color::Black);
   Align();
   m_battle->setFieldOrigin(m_bkg.getPosition());
+  m_thread.reset(new BattleThread(*m_battle));
+  m_thread->Start();
+  m_game_over = false;
+  // бюджет кадров битвы, статистика собирается за время битвы
+  Window* wind = m_stateMgr->GetContext()->m_wind;
+  wind->SetFramePacing(FramePacer::Mode::TARGET_FPS, kBattleFps);
+  wind->GetFramePacer()->ResetStatistics();
 }
 
 
 void State_Battle::Deactivate() {
+  Window* wind = m_stateMgr->GetContext()->m_wind;
+  wind->GetFramePacer()->printStatistics(__FUNCTION__);
+  wind->SetFramePacing(FramePacer::Mode::TARGET_FPS);
+  m_thread.reset(nullptr);
   m_battle->Stop();
   m_battle.reset(nullptr);
+  m_world.reset(nullptr);
   m_panel.reset(nullptr);
 
   m_stateMgr->GetContext()->NextStageFile();
@@ -59,12 +76,20 @@ void State_Battle::Deactivate() {
 }
 
 
-void State_Battle::Update(const sf::Time& l_time) {
-  m_battle->Update(l_time);
-  m_panel->UpdateInfo(m_battle->getInfo().enemies, m_battle->getInfo().lives,
+void State_Battle::Update(const sf::Time&) {
+  // битву обновляет поток моделирования, режим только читает ее состояние
+  const BattleSnapshot& snapshot = m_thread->Acquire();
+  m_panel->UpdateInfo(snapshot.enemies, snapshot.lives,
                       m_stateMgr->GetContext()->getStageNum() + 1);
 
-  if (m_battle->getInfo().geme_over_flag) {
+  if (!snapshot.game_over) return;
+  // пауза перед отчетом - только при отображении, моделирование ее не содержит;
+  // кадры продолжают отображаться, пока она не истечет
+  if (!m_game_over) {
+    m_game_over = true;
+    m_game_over_clock.restart();
+  }
+  if (m_game_over_clock.getElapsedTime().asSeconds() >= kGameOverPause) {
     m_stateMgr->SwitchTo(StateType::BattleReport);
   }
 }
@@ -76,7 +101,7 @@ void State_Battle::Draw() {
 
   window->clear(sf::Color(50,175,175));
   window->draw(m_bkg);
-  m_battle->Draw(*window);
+  m_thread->Acquire().Draw(*window);
   m_panel->Draw(*window);
 }
 
@@ -84,27 +109,27 @@ void State_Battle::Draw() {
 
 // control input Key callback
 void State_Battle::Callback_Up(EventDetails* l_details) {
-  m_battle->Player_up();
+  m_thread->Push(BattleThread::UP);
 }
 
 
 void State_Battle::Callback_Down(EventDetails* l_details) {
-  m_battle->Player_down();
+  m_thread->Push(BattleThread::DOWN);
 }
 
 
 void State_Battle::Callback_Left(EventDetails* l_details) {
-  m_battle->Player_left();
+  m_thread->Push(BattleThread::LEFT);
 }
 
 
 void State_Battle::Callback_Right(EventDetails* l_details) {
-  m_battle->Player_right();
+  m_thread->Push(BattleThread::RIGHT);
 }
 
 
 void State_Battle::Callback_Space(EventDetails* l_details) {
-  m_battle->Player_fire();
+  m_thread->Push(BattleThread::FIRE);
 }
 
 
@@ -12,6 +12,8 @@
 #include <utility>
 #include <stdexcept>
 #include <memory>
+#include <cstdint>
+#include <ctime>
 
 #include "BaseState.h"
 #include "EventManager.h"
@@ -20,6 +22,7 @@
 #include "SpriteManager.h"
 #include "GuiControl.h"
 #include "GameBattleCity.h"
+#include "BattleThread.h"
 
 class InfoPanel;
 
@@ -28,6 +31,9 @@ class InfoPanel;
 /// Основной режим игры. Управляет запуском игровой модели BattleCity и настраивает 
 /// отображение игрового поля и информационной панели в графическом окне.
 /// Настраивает связь событий пользовательского управления с командами управления игрой
+///
+/// Битва моделируется в отдельном потоке (BattleThread): режим передает ему команды
+/// игрока и отображает последнее опубликованное им состояние (BattleSnapshot).
 class State_Battle : public BaseState {
  public:
   State_Battle(StateManager* l_stateManager);
@@ -51,10 +57,22 @@ class State_Battle : public BaseState {
   ///выравнивает совместное отображение игрового поля и информационной панели по центру
   void Align();
 
+  /// мир текущей битвы, создается при активации режима
+  std::unique_ptr<World>      m_world;
   /// экземпляр игровой модели
   std::unique_ptr<BattleCity> m_battle;
+  /// поток моделирования битвы
+  std::unique_ptr<BattleThread> m_thread;
   std::unique_ptr<InfoPanel>  m_panel;
   sf::RectangleShape m_bkg;
+
+  bool      m_game_over = false;    ///< окончание битвы получено от потока моделирования
+  sf::Clock m_game_over_clock;      ///< время после окончания битвы
+
+  /// частота кадров битвы (FramePacer)
+  static constexpr float kBattleFps = 120;
+  /// пауза между окончанием битвы и отчетом (BattleReport), с
+  static constexpr float kGameOverPause = 1.5f;
 };
 
 
@@ -0,0 +1,233 @@
+/// \file
+/// \ingroup battle_city_game_classes
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <utility>
+
+#include <SFML\Graphics.hpp>
+
+#include "BoundsCache.h"
+
+
+/// \ingroup interaction_processing_algorithms
+/// \brief Постоянная структура "sweep and prune" для подвижных юнитов двух типов
+/// \tparam T1,T2 типы игровых сущностей
+///
+/// Для каждого юнита хранится его проекция (интервал) на оси x и y. Списки юнитов,
+/// упорядоченные по началу интервала на каждой оси, сохраняются между шагами и
+/// досортировываются вставками: юниты движутся только вдоль осей и за шаг смещаются
+/// на несколько пикселей, поэтому порядок почти не меняется и сортировка линейна.
+/// Проход вдоль оси с наибольшим разбросом юнитов дает пары с пересекающимися
+/// интервалами, вторая ось отсеивает остальные.
+///
+/// Интервалы строятся по областям BoundsCache, для снарядов это вся область, заметаемая за шаг.
+///
+/// Результат шага - пары (T1, T2) и (T2, T2) в порядке перебора вложенных циклов
+/// по номерам юнитов в кэшах. Пары (T1, T1) не формируются.
+/// \see EntityManager::Interaction
+template <typename T1, typename T2>
+class SweepAndPrune {
+ public:
+  using MixedPairs = std::vector<std::pair<T1*, T2*>>;
+  using SamePairs  = std::vector<std::pair<T2*, T2*>>;
+
+  /// \brief синхронизирует структуру с областями юнитов, сохраненными в кэшах на текущем шаге,
+  /// обновляет интервалы и формирует пары. Номер юнита - его номер в кэше.
+  void Update(BoundsCache<T1>& first, BoundsCache<T2>& second) {
+    ++m_stamp;
+    for (unsigned id = 0; id < first.size(); ++id) {
+      Sync(&first[id], nullptr, first.getBounds(id), id);
+    }
+    for (unsigned id = 0; id < second.size(); ++id) {
+      Sync(nullptr, &second[id], second.getBounds(id), id);
+    }
+    Finish();
+  }
+
+  const MixedPairs& getMixedPairs() const { return m_mixed; }    ///< пары (T1, T2)
+  const SamePairs&  getSamePairs()  const { return m_same; }     ///< пары (T2, T2)
+
+  /// номера участников пары \a i из getMixedPairs в кэшах (T1, T2)
+  std::pair<unsigned, unsigned> getMixedIds(std::size_t i) const { return Ids(m_mixed_order[i]); }
+  /// номера участников пары \a i из getSamePairs в кэше T2
+  std::pair<unsigned, unsigned> getSameIds(std::size_t i) const { return Ids(m_same_order[i]); }
+
+ private:
+  /// проекция юнита на оси
+  struct Proxy {
+    T1*       first = nullptr;                 ///< юнит первого типа (или nullptr)
+    T2*       second = nullptr;                ///< юнит второго типа (или nullptr)
+    float     min[2];                          ///< начало интервала по осям x, y
+    float     max[2];                          ///< конец интервала по осям x, y
+    unsigned  order = 0;                       ///< позиция юнита в его хранилище
+    unsigned  stamp = 0;                       ///< шаг последней синхронизации
+  };
+
+  void Sync(T1* first, T2* second, const sf::FloatRect& rec, unsigned order) {
+    const void* key = first ? static_cast<const void*>(first) : static_cast<const void*>(second);
+    unsigned id;
+    auto iter = m_index.find(key);
+    if (iter == m_index.end()) {
+      if (m_free.empty()) {
+        id = static_cast<unsigned>(m_proxies.size());
+        m_proxies.emplace_back();
+      }
+      else {
+        id = m_free.back();
+        m_free.pop_back();
+      }
+      m_index.emplace(key, id);
+      m_axis[0].push_back(id);
+      m_axis[1].push_back(id);
+    }
+    else {
+      id = iter->second;
+    }
+    Proxy& proxy = m_proxies[id];
+    proxy.first = first;
+    proxy.second = second;
+    proxy.order = order;
+    proxy.stamp = m_stamp;
+    proxy.min[0] = rec.left;
+    proxy.min[1] = rec.top;
+    proxy.max[0] = rec.left + rec.width;
+    proxy.max[1] = rec.top + rec.height;
+  }
+
+  /// удаляет исчезнувшие проекции, досортировывает оси и формирует пары
+  void Finish() {
+    RemoveLost();
+    SortAxis(m_axis[0], 0);
+    SortAxis(m_axis[1], 1);
+    Sweep(SweepAxis());
+  }
+
+  /// удаляет проекции юнитов, исчезнувших из хранилищ
+  void RemoveLost() {
+    auto lost = [this](unsigned id) { return m_proxies[id].stamp != m_stamp; };
+    for (auto& axis : m_axis) {
+      axis.erase(std::remove_if(axis.begin(), axis.end(), lost), axis.end());
+    }
+    for (auto iter = m_index.begin(); iter != m_index.end(); ) {
+      if (lost(iter->second)) {
+        m_free.push_back(iter->second);
+        iter = m_index.erase(iter);
+      }
+      else {
+        ++iter;
+      }
+    }
+  }
+
+  /// сортировка вставками по началу интервала: O(n) для почти упорядоченного списка
+  void SortAxis(std::vector<unsigned>& axis, int a) {
+    for (std::size_t i = 1; i < axis.size(); ++i) {
+      unsigned id = axis[i];
+      float key = m_proxies[id].min[a];
+      std::size_t j = i;
+      for (; j > 0 && m_proxies[axis[j - 1]].min[a] > key; --j) {
+        axis[j] = axis[j - 1];
+      }
+      axis[j] = id;
+    }
+  }
+
+  /// ось с наибольшей дисперсией центров интервалов
+  int SweepAxis() const {
+    float sum[2] = { 0, 0 }, sum2[2] = { 0, 0 };
+    for (const auto& proxy : m_proxies) {
+      if (proxy.stamp != m_stamp) continue;
+      for (int a = 0; a < 2; ++a) {
+        float c = (proxy.min[a] + proxy.max[a]) / 2;
+        sum[a] += c;
+        sum2[a] += c * c;
+      }
+    }
+    float n = static_cast<float>(m_index.size());
+    if (n == 0) return 0;
+    float var_x = sum2[0] - sum[0] * sum[0] / n;
+    float var_y = sum2[1] - sum[1] * sum[1] / n;
+    return var_x >= var_y ? 0 : 1;
+  }
+
+  void Sweep(int a) {
+    int b = 1 - a;
+    const std::vector<unsigned>& axis = m_axis[a];
+    m_mixed.clear();
+    m_same.clear();
+    m_mixed_order.clear();
+    m_same_order.clear();
+    for (std::size_t i = 0; i < axis.size(); ++i) {
+      const Proxy& p = m_proxies[axis[i]];
+      for (std::size_t j = i + 1; j < axis.size(); ++j) {
+        const Proxy& q = m_proxies[axis[j]];
+        if (q.min[a] > p.max[a]) break;
+        if (q.min[b] > p.max[b] || p.min[b] > q.max[b]) continue;
+        AddPair(p, q);
+      }
+    }
+    SortPairs(m_mixed, m_mixed_order, m_mixed_sorted);
+    SortPairs(m_same, m_same_order, m_same_sorted);
+  }
+
+  void AddPair(const Proxy& p, const Proxy& q) {
+    if (p.first && q.first) return;
+    if (p.first) {
+      m_mixed.emplace_back(p.first, q.second);
+      m_mixed_order.push_back(Order(p.order, q.order));
+    }
+    else if (q.first) {
+      m_mixed.emplace_back(q.first, p.second);
+      m_mixed_order.push_back(Order(q.order, p.order));
+    }
+    else if (p.order < q.order) {
+      m_same.emplace_back(p.second, q.second);
+      m_same_order.push_back(Order(p.order, q.order));
+    }
+    else {
+      m_same.emplace_back(q.second, p.second);
+      m_same_order.push_back(Order(q.order, p.order));
+    }
+  }
+
+  static unsigned long long Order(unsigned outer, unsigned inner) {
+    return (static_cast<unsigned long long>(outer) << 32) | inner;
+  }
+
+  static std::pair<unsigned, unsigned> Ids(unsigned long long order) {
+    return { static_cast<unsigned>(order >> 32), static_cast<unsigned>(order & 0xFFFFFFFFu) };
+  }
+
+  /// упорядочивает пары как вложенные циклы перебора по хранилищам
+  /// (ключи \a order упорядочиваются вместе с ними, ключи пар различны)
+  /// \param sorted буфер перестановки, обменивается с \a pairs (память сохраняется между шагами)
+  template <typename Pairs>
+  void SortPairs(Pairs& pairs, std::vector<unsigned long long>& order, Pairs& sorted) {
+    m_perm.resize(pairs.size());
+    for (std::size_t i = 0; i < m_perm.size(); ++i) m_perm[i] = static_cast<unsigned>(i);
+    std::sort(m_perm.begin(), m_perm.end(), [&order](unsigned l, unsigned r) {
+      return order[l] < order[r];
+    });
+    sorted.clear();
+    for (unsigned i : m_perm) sorted.push_back(pairs[i]);
+    pairs.swap(sorted);
+    std::sort(order.begin(), order.end());
+  }
+
+  std::vector<Proxy>                      m_proxies;
+  std::vector<unsigned>                   m_free;          ///< свободные номера проекций
+  std::vector<unsigned>                   m_axis[2];       ///< упорядоченные списки по осям x, y
+  std::unordered_map<const void*, unsigned> m_index;       ///< юнит -> номер проекции
+  unsigned                                m_stamp = 0;     ///< номер шага синхронизации
+
+  MixedPairs                    m_mixed;
+  SamePairs                     m_same;
+  std::vector<unsigned long long> m_mixed_order;           ///< номера участников m_mixed (Order)
+  std::vector<unsigned long long> m_same_order;            ///< номера участников m_same (Order)
+  std::vector<unsigned>         m_perm;
+  MixedPairs                    m_mixed_sorted;            ///< буфер SortPairs для m_mixed
+  SamePairs                     m_same_sorted;             ///< буфер SortPairs для m_same
+};
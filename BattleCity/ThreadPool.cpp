@@ -0,0 +1,89 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned workers) {
+  for (unsigned i = 0; i < workers; ++i) {
+    m_workers.emplace_back([this]() { WorkerLoop(); });
+  }
+}
+
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  for (auto& worker : m_workers) worker.join();
+}
+
+
+ThreadPool& ThreadPool::Shared() {
+  static ThreadPool* pool = new ThreadPool(
+    std::max(std::thread::hardware_concurrency(), 1u) - 1);
+  return *pool;
+}
+
+
+void ThreadPool::ParallelFor(std::size_t count, std::size_t grain, const Job& job) {
+  if (!count) return;
+  grain = std::max<std::size_t>(grain, 1);
+  if (m_workers.empty() || count <= grain) {
+    job(0, count);
+    return;
+  }
+  auto batch = std::make_shared<Batch>();
+  batch->job = &job;
+  batch->count = count;
+  batch->grain = grain;
+  batch->chunks = (count + grain - 1) / grain;
+  batch->next = 0;
+  batch->done = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_batches.push_back(batch);
+  }
+  m_wake.notify_all();
+
+  RunBatch(*batch);
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  auto iter = std::find(m_batches.begin(), m_batches.end(), batch);
+  if (iter != m_batches.end()) m_batches.erase(iter);
+  m_finished.wait(lock, [&batch]() { return batch->done == batch->chunks; });
+}
+
+
+void ThreadPool::RunBatch(Batch& batch) {
+  for (;;) {
+    std::size_t chunk = batch.next++;
+    if (chunk >= batch.chunks) return;
+    std::size_t begin = chunk * batch.grain;
+    std::size_t end = std::min(begin + batch.grain, batch.count);
+    (*batch.job)(begin, end);
+    if (++batch.done == batch.chunks) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_finished.notify_all();
+    }
+  }
+}
+
+
+void ThreadPool::WorkerLoop() {
+  for (;;) {
+    std::shared_ptr<Batch> batch;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wake.wait(lock, [this]() { return m_stop || !m_batches.empty(); });
+      if (m_stop) return;
+      batch = m_batches.front();
+      if (batch->next >= batch->chunks) {
+        // все блоки уже разобраны, диапазон больше не нужен в очереди
+        m_batches.pop_front();
+        continue;
+      }
+    }
+    RunBatch(*batch);
+  }
+}
@@ -0,0 +1,66 @@
+/// \file
+/// \ingroup battle_city_game_classes
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+
+/// \brief Набор рабочих потоков для параллельной обработки диапазонов
+///
+/// Диапазон [0, count) делится на блоки по \a grain элементов, которые разбирают
+/// свободные рабочие потоки и сам вызывающий поток. Вызов ParallelFor возвращается
+/// только после обработки всех блоков. Вызывающий поток всегда участвует в работе,
+/// поэтому вложенные вызовы из рабочих потоков не приводят к взаимной блокировке.
+///
+/// Распределение блоков по потокам не детерминировано, поэтому задача должна
+/// записывать результат только в собственные элементы диапазона.
+/// \see EntityManager::NarrowPhase
+class ThreadPool {
+ public:
+  /// обработчик блока [begin, end)
+  using Job = std::function<void(std::size_t begin, std::size_t end)>;
+
+  /// \param workers количество рабочих потоков (0 - все вычисления в вызывающем потоке)
+  explicit ThreadPool(unsigned workers);
+  ~ThreadPool();
+  ThreadPool(ThreadPool&)            = delete;
+  ThreadPool& operator=(ThreadPool&) = delete;
+
+  /// выполняет \a job над всеми блоками диапазона [0, count)
+  /// \param grain размер блока; диапазон не больше блока выполняется без передачи потокам
+  void ParallelFor(std::size_t count, std::size_t grain, const Job& job);
+
+  unsigned getWorkersNum() const { return static_cast<unsigned>(m_workers.size()); }
+
+  /// общий набор потоков программы (по числу ядер процессора).
+  /// \note создается при первом обращении, потоки завершаются ОС вместе с программой
+  static ThreadPool& Shared();
+
+ private:
+  /// диапазон, разбираемый потоками по блокам
+  struct Batch {
+    const Job*                job = nullptr;
+    std::size_t               count = 0;
+    std::size_t               grain = 1;
+    std::size_t               chunks = 0;      ///< количество блоков
+    std::atomic<std::size_t>  next;            ///< следующий свободный блок
+    std::atomic<std::size_t>  done;            ///< обработанные блоки
+  };
+
+  void WorkerLoop();
+  void RunBatch(Batch& batch);
+
+  std::vector<std::thread>            m_workers;
+  std::deque<std::shared_ptr<Batch>>  m_batches;   ///< диапазоны с неразобранными блоками
+  std::mutex                          m_mutex;
+  std::condition_variable             m_wake;      ///< появился новый диапазон
+  std::condition_variable             m_finished;  ///< обработан последний блок диапазона
+  bool                                m_stop = false;
+};
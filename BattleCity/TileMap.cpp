@@ -0,0 +1,54 @@
+#include "TileMap.h"
+
+void TileMap::Reset(sf::Vector2u cells, sf::Vector2f block) {
+  m_cells = cells;
+  m_block = block;
+  m_tiles.assign(cells.x * cells.y, Tile());
+}
+
+
+bool TileMap::Place(Barrier& barrier) {
+  sf::FloatRect rec = barrier.getBounds();
+  if (rec.left < 0 || rec.top < 0) return false;
+  float fx = rec.left / m_block.x;
+  float fy = rec.top / m_block.y;
+  float fw = rec.width / m_block.x;
+  float fh = rec.height / m_block.y;
+  unsigned x = unsigned(fx + 0.5f);
+  unsigned y = unsigned(fy + 0.5f);
+  unsigned w = unsigned(fw + 0.5f);
+  unsigned h = unsigned(fh + 0.5f);
+  const float eps = 0.01f;
+  if (w == 0 || h == 0 || x + w > m_cells.x || y + h > m_cells.y ||
+      std::abs(fx - x) > eps || std::abs(fy - y) > eps ||
+      std::abs(fw - w) > eps || std::abs(fh - h) > eps) {
+    return false;
+  }
+  const BarrierTypeInfo& info = barrier.getInfo();
+  Tile tile;
+  tile.barrier = &barrier;
+  tile.obstruct_Z_eq_0 = info.obstruct_Z_eq_0;
+  tile.obstruct_Z_greater_0 = info.obstruct_Z_greater_0;
+  tile.x0 = std::uint16_t(x);
+  tile.y0 = std::uint16_t(y);
+  tile.width = std::uint16_t(w);
+  tile.height = std::uint16_t(h);
+  tile.bounds = rec;
+  for (unsigned j = y; j < y + h; ++j) {
+    for (unsigned i = x; i < x + w; ++i) {
+      m_tiles[j * m_cells.x + i] = tile;
+    }
+  }
+  return true;
+}
+
+
+void TileMap::Erase(unsigned x, unsigned y) {
+  Tile tile = at(x, y);
+  if (!tile.barrier) return;
+  for (unsigned j = tile.y0; j < tile.y0 + tile.height; ++j) {
+    for (unsigned i = tile.x0; i < tile.x0 + tile.width; ++i) {
+      m_tiles[j * m_cells.x + i] = Tile();
+    }
+  }
+}
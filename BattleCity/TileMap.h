@@ -0,0 +1,85 @@
+/// \file
+/// \ingroup battle_city_game_classes
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include <SFML\Graphics.hpp>
+
+#include "Units.h"
+
+
+/// \brief Плотная сетка клеток карты с препятствиями, размещенными по блокам схемы карты
+///
+/// Препятствия, созданные BattleCity::ConvertMapScheme, занимают целое число клеток карты
+///   (объединенные препятствия - прямоугольник из нескольких клеток).
+/// Для каждой клетки хранится указатель на препятствие и копия флагов проходимости
+///   его подтипа (BarrierTypeInfo::obstruct_Z_eq_0, BarrierTypeInfo::obstruct_Z_greater_0),
+///   поэтому проверка танка или снаряда с ландшафтом сводится к перебору нескольких клеток,
+///   перекрываемых его областью, вместо перебора всего хранилища препятствий.
+/// Препятствия, не выровненные по клеткам (например, границы карты), в сетку не помещаются.
+///
+/// \note Значение флагов совпадает с файлом подтипов: 1 - объект проходит сквозь препятствие.
+/// \see EntityManager::BuildTileMap, EntityManager::Interaction
+class TileMap {
+ public:
+  /// содержимое клетки карты
+  struct Tile {
+    Barrier*  barrier = nullptr;               ///< препятствие в клетке (nullptr - пусто)
+    bool      obstruct_Z_eq_0 = true;          ///< \copydoc BarrierTypeInfo::obstruct_Z_eq_0
+    bool      obstruct_Z_greater_0 = true;     ///< \copydoc BarrierTypeInfo::obstruct_Z_greater_0
+    std::uint16_t x0 = 0, y0 = 0;              ///< первая клетка препятствия
+    std::uint16_t width = 0, height = 0;       ///< размер препятствия в клетках
+    sf::FloatRect bounds;                      ///< область препятствия (препятствия неподвижны)
+  };
+
+  /// очищает карту и задает ее размеры
+  /// \param cells  количество клеток по горизонтали и вертикали
+  /// \param block  размер клетки
+  void Reset(sf::Vector2u cells, sf::Vector2f block);
+
+  /// помещает препятствие во все клетки, если его область в точности совпадает с ними
+  /// (флаги проходимости клеток - из параметров подтипа Barrier::getInfo)
+  /// \return false, если препятствие не выровнено по сетке или выходит за пределы карты
+  bool Place(Barrier& barrier);
+
+  /// освобождает все клетки препятствия, занимающего клетку (например, при разрушении кирпича)
+  void Erase(unsigned x, unsigned y);
+
+  const Tile& at(unsigned x, unsigned y) const { return m_tiles[y * m_cells.x + x]; }
+  sf::Vector2u getSize() const { return m_cells; }
+
+  /// вызывает Operation(const Tile&, unsigned x, unsigned y) для занятых клеток,
+  /// перекрываемых областью. Порядок перебора - построчный, как при создании карты.
+  /// Препятствие из нескольких клеток передается один раз, в первой перекрытой клетке.
+  template <typename Operation>
+  void ForEachTile(const sf::FloatRect& rec, Operation op) const {
+    if (m_tiles.empty()) return;
+    int x0 = Clamp(std::floor(rec.left / m_block.x), m_cells.x);
+    int y0 = Clamp(std::floor(rec.top / m_block.y), m_cells.y);
+    int x1 = Clamp(std::floor((rec.left + rec.width) / m_block.x), m_cells.x);
+    int y1 = Clamp(std::floor((rec.top + rec.height) / m_block.y), m_cells.y);
+    for (int y = y0; y <= y1; ++y) {
+      for (int x = x0; x <= x1; ++x) {
+        const Tile& tile = at(x, y);
+        if (tile.barrier && x == std::max<int>(x0, tile.x0) && y == std::max<int>(y0, tile.y0)) {
+          op(tile, unsigned(x), unsigned(y));
+        }
+      }
+    }
+  }
+
+ private:
+  static int Clamp(float cell, unsigned size) {
+    if (cell < 0) return 0;
+    if (cell > size - 1.0f) return int(size) - 1;
+    return int(cell);
+  }
+
+  std::vector<Tile> m_tiles;                   ///< клетки карты построчно
+  sf::Vector2u      m_cells;                   ///< размер карты в клетках
+  sf::Vector2f      m_block;                   ///< размер клетки
+};
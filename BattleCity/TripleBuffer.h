@@ -0,0 +1,56 @@
+/// \file
+/// \ingroup battle_city_game_classes
+#pragma once
+
+#include <array>
+#include <atomic>
+
+
+/// \brief Тройной буфер для передачи состояний от одного потока-производителя
+/// одному потоку-потребителю без блокировок
+/// \tparam T передаваемое состояние (BattleSnapshot)
+///
+/// Производитель заполняет свой буфер (Write) и публикует его (Publish),
+/// потребитель забирает последний опубликованный буфер (Acquire) и читает его (Read).
+/// Третий буфер - последний опубликованный, еще не забранный потребителем - передается
+/// между ними атомарной заменой индекса, поэтому ни один поток не ожидает другой:
+/// производитель не блокируется медленным потребителем (промежуточные состояния
+/// пропускаются), потребитель повторно читает прошлое состояние, пока нет нового.
+/// Буферы не освобождаются между передачами, поэтому их память используется повторно.
+template <typename T>
+class TripleBuffer {
+ public:
+  TripleBuffer() = default;
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  /// буфер производителя
+  T& Write() { return m_buffers[m_write]; }
+
+  /// публикует буфер производителя, производитель получает свободный буфер
+  void Publish() {
+    unsigned prev = m_ready.exchange(m_write | kFresh, std::memory_order_acq_rel);
+    m_write = prev & kIndex;
+  }
+
+  /// \brief забирает последний опубликованный буфер
+  /// \return \a true - опубликован новый буфер, \a false - Read остается прежним
+  bool Acquire() {
+    if (!(m_ready.load(std::memory_order_relaxed) & kFresh)) return false;
+    unsigned prev = m_ready.exchange(m_read, std::memory_order_acq_rel);
+    m_read = prev & kIndex;
+    return true;
+  }
+
+  /// буфер потребителя (до первой публикации - состояние по умолчанию)
+  T& Read() { return m_buffers[m_read]; }
+
+ private:
+  static const unsigned kIndex = 3;       ///< маска номера буфера
+  static const unsigned kFresh = 4;       ///< метка неполученной публикации
+
+  std::array<T, 3>      m_buffers;
+  unsigned              m_write = 0;      ///< буфер производителя
+  unsigned              m_read = 1;       ///< буфер потребителя
+  std::atomic<unsigned> m_ready{ 2 };     ///< опубликованный буфер и метка kFresh
+};
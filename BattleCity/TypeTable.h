@@ -0,0 +1,112 @@
+/// \file
+/// \ingroup battle_city_game_classes
+#pragma once
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+
+/// \brief Неизменяемый набор параметров подтипов, индексируемый символом подтипа
+/// \tparam T_info параметры подтипа (TankTypeInfo, BulletTypeInfo, ...), с полем char type
+///
+/// Записи подтипов хранятся в порядке загрузки, а поиск выполняется по плотной таблице
+/// из 256 указателей, индексируемой символом подтипа, без хеширования и сравнения ключей.
+/// После создания набор не меняется, поэтому адреса записей постоянны (экземпляры
+/// сохраняют указатель на свою запись при создании) и один набор может одновременно
+/// использоваться мирами в разных потоках.
+/// \see Factory::LoadCollection
+template <typename T_info>
+class TypeTable {
+ public:
+  using const_iterator = typename std::vector<T_info>::const_iterator;
+
+  TypeTable() { m_index.fill(nullptr); }
+
+  /// \param records параметры подтипов; при повторе символа подтипа действует первая запись
+  explicit TypeTable(std::vector<T_info> records) : m_records(std::move(records)) {
+    m_index.fill(nullptr);
+    for (const T_info& item : m_records) {
+      const T_info*& slot = m_index[static_cast<unsigned char>(item.type)];
+      if (!slot) slot = &item;
+    }
+  }
+  TypeTable(const TypeTable&) = delete;
+  TypeTable& operator=(const TypeTable&) = delete;
+
+  /// параметры подтипа \a type (nullptr - подтип не загружен)
+  const T_info* find(char type) const { return m_index[static_cast<unsigned char>(type)]; }
+
+  /// параметры подтипа \a type
+  /// \throw std::out_of_range подтип не загружен
+  const T_info& at(char type) const {
+    const T_info* item = find(type);
+    if (!item) throw std::out_of_range("unknown subtype");
+    return *item;
+  }
+
+  const_iterator begin() const { return m_records.begin(); }
+  const_iterator end() const   { return m_records.end(); }
+  std::size_t size() const     { return m_records.size(); }
+  bool empty() const           { return m_records.empty(); }
+
+  /// \brief набор подтипов из файла, общий для всех обращений к тому же файлу.
+  /// Файл читается при первом обращении, пока набор используется хотя бы одним миром,
+  /// повторные обращения возвращают тот же набор.
+  static std::shared_ptr<const TypeTable> Load(const std::string& file) {
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<const TypeTable>> loaded;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const TypeTable> table = loaded[file].lock();
+    if (!table) {
+      table = std::make_shared<const TypeTable>(ReadRecords(file));
+      loaded[file] = table;
+    }
+    return table;
+  }
+
+ private:
+  /// чтение записей подтипов из файла, по одной в строке ('#' - комментарий)
+  static std::vector<T_info> ReadRecords(const std::string& file) {
+    using namespace std;
+
+    ifstream fin(file);
+    if (!fin.is_open()) {
+      cout << "No find file: " << file << endl;
+      getchar();
+      throw invalid_argument("Can't open tiles file");
+    }
+
+    vector<T_info> records;
+    string line;
+    int line_cnt = 0;
+    while (getline(fin, line)) {
+      ++line_cnt;
+      if (line[0] == '#') continue;  // comments
+
+      istringstream is(line);
+      T_info tmp_info;
+      if (is >> tmp_info) {
+        records.push_back(std::move(tmp_info));
+      }
+      else {
+        cout << " can't load line N " << line_cnt << " : ";
+        cout << line << endl;
+        getchar();
+        throw invalid_argument("Can't load tile sprites");
+      }
+    }
+    return records;
+  }
+
+  std::vector<T_info>             m_records;    ///< записи в порядке загрузки
+  std::array<const T_info*, 256>  m_index;      ///< символ подтипа -> запись
+};
@@ -1,4 +1,5 @@
 #include "Units.h"
+#include "World.h"
 
 std::istream& operator>>(std::istream& is, TankTypeInfo& item) {
   return is >> item.name >> item.type >> item.size.x >> item.size.y
@@ -13,10 +14,13 @@ std::ostream& operator<<(std::ostream& is, const TankTypeInfo& item) {
 }
 
 
-unsigned Tank::id_cnt = 0;
-Tank::Tank(char type, float time) : GameEntity( ), m_type(type), 
-                                    m_id(id_cnt++), m_time_last(time) {
-  m_state = BIRTH;
+Tank::Tank(World& world, const Info& info, float time)
+    : GameEntity(world), m_hot(this, world.getFactory<Tank>().getTable()),
+      m_id(world.getFactory<Tank>().NextId()), m_type(info.type), m_info(&info),
+      m_time_last(time) {
+  m_hot.status() = BIRTH;
+  m_hot.size() = info.size;
+  m_hot.faction() = m_type == 'e' ? Faction::PLAYER : Faction::ENEMY;
   m_anim_list.InsertBack(unique_anim<AnimSingle>(time, "Flare"));
   m_callback = []() {};
 }
@@ -29,11 +33,11 @@ void Tank::Update(const sf::Time& time) {
   // обновление автопилота
   if (m_Driver) m_Driver->ApplyControl(m_time_last);
   // проверка состояний
-  switch (m_state)
+  switch (m_hot.status())
   {
   case BIRTH:
     if (m_anim_list.IsCompleted()) setStateActiveNormal();
-    m_anim_list.setPosition(m_pos);
+    m_anim_list.setPosition(m_hot.pos());
     break;
   case ACTIVE:
     UpdateActiveState( );
@@ -70,8 +74,10 @@ void Tank::UpdateActiveState( ) {
 }
 
 
-void Tank::Draw(sf::RenderWindow& window) {
-  m_anim_list.Draw(window);
+void Tank::Capture(DrawList& list) {
+  // позиция могла измениться проходом перемещения после Update
+  m_anim_list.setPosition(m_hot.pos());
+  m_anim_list.Capture(list);
 }
 
 void Tank::Interaction(GameEntity&) {
@@ -79,68 +85,79 @@ void Tank::Interaction(GameEntity&) {
 }
 
 void Tank::setPosition(sf::Vector2f pos) {
-  m_pos_last = m_pos;
-  m_pos = pos;
+  Wake();
+  m_hot.posLast() = m_hot.pos();
+  m_hot.pos() = pos;
   m_anim_list.setPosition(pos);
 }
 
+sf::FloatRect Tank::getMotionBounds() const {
+  return m_hot.getTable().getMotionBounds(m_hot.getIndex());
+}
+
 void Tank::setOrientation(direction dir) {
-  m_dir = dir;
+  Wake();
+  m_hot.dir() = dir;
   m_anim_list.setOrientation(dir);
 }
 
 sf::Vector2f Tank::getPosition() const {
-  return m_pos;
+  return m_hot.pos();
 }
 
 sf::Vector2f Tank::getSize() const {
-  return factory::s_collection.at(m_type).size;
+  return m_hot.size();
 }
 
 
 //    TANK CALLBACK
 void Tank::Left() {
-  if (m_state != ACTIVE || m_tank_state == FREEZE) return;
+  if (m_hot.status() != ACTIVE || m_tank_state == FREEZE) return;
   
-  if (m_dir != LEFT) setOrientation(LEFT);
+  if (m_hot.dir() != LEFT) setOrientation(LEFT);
   m_move_flag = true;
 }
 
 void Tank::Ridht() {
-  if (m_state != ACTIVE || m_tank_state == FREEZE) return;
+  if (m_hot.status() != ACTIVE || m_tank_state == FREEZE) return;
 
-  if (m_dir != RIGHT) setOrientation(RIGHT);
+  if (m_hot.dir() != RIGHT) setOrientation(RIGHT);
   m_move_flag = true;
 }
 
 void Tank::Forward() {
-  if (m_state != ACTIVE || m_tank_state == FREEZE) return;
+  if (m_hot.status() != ACTIVE || m_tank_state == FREEZE) return;
 
-  if (m_dir != FORWD) setOrientation(FORWD);
+  if (m_hot.dir() != FORWD) setOrientation(FORWD);
   m_move_flag = true;
 }
 
 void Tank::Back() {
-  if (m_state != ACTIVE || m_tank_state == FREEZE) return;
+  if (m_hot.status() != ACTIVE || m_tank_state == FREEZE) return;
 
-  if (m_dir != BACK) setOrientation(BACK);
+  if (m_hot.dir() != BACK) setOrientation(BACK);
   m_move_flag = true;
 }
 
 void Tank::Fire() {
   if (m_time_last - m_time_fire_last < m_delay_fire ||
-    m_state != ACTIVE || m_tank_state == FREEZE) {
+    m_hot.status() != ACTIVE || m_tank_state == FREEZE) {
     return;
   }
+  // место для нового снаряда: снаряд удален или уже разорвался
+  auto slot = std::find_if(m_bullets.begin(), m_bullets.end(),
+    [](const SlotMap<Bullet>::Handle& item) { return !item || !item->isFlying(); });
+  if (slot == m_bullets.end()) return;
   m_time_fire_last = m_time_last;
-  char bullet_type = Tank::factory::s_collection[m_type].bullet_type;
-  auto bullet = Bullet::factory::Create(bullet_type, m_time_last);
-  bullet->setDirection(m_dir);
-  bullet->setPosition(m_pos);
+  auto bullet = m_world.getFactory<Bullet>().Create(m_info->bullet_type, m_time_last);
+  *slot = bullet;
+  bullet->setOwner(m_id, m_hot.faction());
+  bullet->setDirection(m_hot.dir());
+  bullet->setPosition(m_hot.pos());
 }
 
 void Tank::setAutoPilot( ) {
-  m_Driver.reset(new TankDriver(*this));
+  m_Driver.reset(new TankDriver(*this, m_world.getRandom()));
 }
 
 void Tank::setAutoPilot(TankDriverBase&& tank_capitan) {
@@ -149,48 +166,50 @@ void Tank::setAutoPilot(TankDriverBase&& tank_capitan) {
 
 //    TANK STATES
 void Tank::setStateActiveNormal() {
-  m_state = ACTIVE;
+  Wake();
+  m_hot.status() = ACTIVE;
   m_tank_state = NORMAL;
   // anim settings
   m_anim_list.Clear();
-  const std::string& name = factory::s_collection.at(m_type).name;
-  m_anim_list.InsertBack(unique_anim<AnimLoop>(m_time_last, name));
-  m_anim_list.setPosition(m_pos);
-  m_anim_list.setOrientation(m_dir);
+  m_anim_list.InsertBack(unique_anim<AnimLoop>(m_time_last, m_info->name));
+  m_anim_list.setPosition(m_hot.pos());
+  m_anim_list.setOrientation(m_hot.dir());
 }
 
 void Tank::setStateFreeze() {
+  Wake();
   m_tank_state = FREEZE;
   // anim settings
   m_anim_list.Clear();
-  const std::string& name = factory::s_collection.at(m_type).name;
-  auto tmp = unique_anim<AnimLoop>(m_time_last, name);
+  auto tmp = unique_anim<AnimLoop>(m_time_last, m_info->name);
   tmp->setTimer(4);
   tmp->setBlink(0.1, sf::Color(100, 150, 250, 200));
   m_anim_list.InsertBack(std::move(tmp));
-  m_anim_list.setPosition(m_pos);
-  m_anim_list.setOrientation(m_dir);
+  m_anim_list.setPosition(m_hot.pos());
+  m_anim_list.setOrientation(m_hot.dir());
 }
 
 void Tank::setStateImmortal() {
+  Wake();
   m_tank_state = IMMORTAL;
   // anim settings
   auto tmp = unique_anim<AnimLoop>(m_time_last, "Shine");
   tmp->setTimer(10);
   m_anim_list.InsertBack(std::move(tmp));
-  m_anim_list.setPosition(m_pos);
-  m_anim_list.setOrientation(m_dir);
+  m_anim_list.setPosition(m_hot.pos());
+  m_anim_list.setOrientation(m_hot.dir());
 }
 
 
 void Tank::setStateDestruction() {
-  if (m_state == DESTRUC) return;
-  m_state = DESTRUC;
+  if (m_hot.status() == DESTRUC) return;
+  Wake();
+  m_hot.status() = DESTRUC;
   // anim settings
   m_anim_list.Clear();
   auto& anim = m_anim_list.InsertBack(unique_anim<AnimSingle>(m_time_last, "Bang"));
-  anim->setPosition(m_pos);
-  m_callback();
+  anim->setPosition(m_hot.pos());
+  m_world.getRegistry().Defer(m_callback);
 }
 
 
@@ -204,14 +223,14 @@ void Tank::UpdatePosition( ) {
   if (m_move_flag == false) return;
   m_move_flag = false;
   ++m_move_delay;
-  int speed = factory::s_collection.at(m_type).speed;
-  sf::Vector2f shift = MovingShift2D(m_elepsed_time, speed, m_dir);
-  setPosition({m_pos.x + shift.x, m_pos.y + shift.y});
+  // позиция меняется проходом EntityManager::IntegratePass
+  Wake();
+  m_hot.Move(m_elepsed_time * m_info->speed);
 }
 
 
 
-TankDriver::TankDriver(Tank& tank) : TankDriverBase(tank) {
+TankDriver::TankDriver(Tank& tank, Random& random) : TankDriverBase(tank), m_random(random) {
   m_dir = getRandomDir();
 }
 
@@ -250,7 +269,7 @@ void TankDriver::ApplyControl(float time ) {
 
 
 direction TankDriver::getRandomDir() {
-  int dir = rand() % 4 * 90 - 90;
+  int dir = int(m_random.Uniform(4)) * 90 - 90;
   direction d = static_cast<direction>(dir);
   //std::cout << "random direction\t: " << (int)d << std::endl;
   return d;
@@ -275,45 +294,49 @@ std::ostream& operator<<(std::ostream& is, const BulletTypeInfo& item) {
 }
 
 
-unsigned Bullet::id_cnt = 0;
-Bullet::Bullet(char type, float time) : GameEntity(), m_type(type), 
-                                        m_id(id_cnt++), m_time_last(time), m_state(ACTIVE) {
-  using namespace std;
-  unique_ptr<AnimBase> tmp_anim(new AnimBase(time));
-  tmp_anim->setSprite("slow_soft");
-  m_anim_list.InsertBack(std::move(tmp_anim));
+Bullet::Bullet(World& world, const Info& info, float time)
+    : GameEntity(world), m_hot(this, world.getFactory<Bullet>().getTable()),
+      m_id(world.getFactory<Bullet>().NextId()), m_type(info.type), m_info(&info),
+      m_flight(time), m_bang(time, "Bang"), m_time_last(time) {
+  m_hot.status() = ACTIVE;
+  m_hot.size() = info.size;
+  m_hot.faction() = m_type == 'S' ? Faction::PLAYER : Faction::ENEMY;
+  m_flight.setSprite("slow_soft");
 }
 
 void Bullet::Update(const sf::Time& time) {
-  switch (m_state) 
+  switch (m_hot.status()) 
   {
   case ACTIVE :
     UpdatePosition(time);
     break;
   case DESTRUC :
-    if (m_anim_list.IsCompleted()) m_destroyed = true;
-    break;
+    m_bang.Update(time.asSeconds());
+    if (m_bang.IsCompleted()) m_destroyed = true;
+    return;
   default :
     ;
   }
-  //m_anim.Update(time);
-  m_anim_list.Update(time.asSeconds());
+  m_flight.Update(time.asSeconds());
 }
 
-void Bullet::Draw(sf::RenderWindow& window) {
-  /*if (!m_anim.IsCompleted()) {
-    m_anim.Draw(window);
-  }*/
-  m_anim_list.Draw(window);
+void Bullet::Capture(DrawList& list) {
+  if (m_hot.status() != DESTRUC) {
+    // позиция могла измениться проходом перемещения после Update
+    m_flight.setPosition(m_hot.pos());
+    m_flight.Capture(list);
+  }
+  else if (!m_bang.IsCompleted()) {
+    m_bang.Capture(list);
+  }
 }
 
 void Bullet::setStateDestruction() {
-  if (m_state == DESTRUC) return;
-  m_state = DESTRUC;
-  
-  m_anim_list.Clear();
-  auto& tmp = m_anim_list.InsertBack(unique_anim<AnimSingle>(m_time_last, "Bang"));
-  tmp->setPosition(m_pos);
+  if (m_hot.status() == DESTRUC) return;
+  Wake();
+  m_hot.status() = DESTRUC;
+  m_bang.Restart(m_time_last);
+  m_bang.setPosition(m_hot.pos());
 }
 
 void Bullet::Interaction(GameEntity&) {
@@ -321,23 +344,29 @@ void Bullet::Interaction(GameEntity&) {
 }
 
 void Bullet::setPosition(sf::Vector2f pos) {
-  m_pos = pos;
-  //m_anim.setPosition(pos);
-  m_anim_list.setPosition(pos);
+  Wake();
+  m_hot.pos() = pos;
+  m_hot.posLast() = pos;
+  m_flight.setPosition(pos);
+  m_bang.setPosition(pos);
 }
 
 sf::Vector2f Bullet::getPosition() const {
-  return m_pos;
+  return m_hot.pos();
 }
 
 sf::Vector2f Bullet::getSize() const {
-  return factory::s_collection.at(m_type).size;
+  return m_hot.size();
+}
+
+void Bullet::setOwner(int id, Faction faction) {
+  m_hot.owner() = id;
+  m_hot.faction() = faction;
 }
 
 void Bullet::setDirection(direction dir) { 
-  m_dir = dir; 
-  //m_anim.setOrientation(dir);
-  m_anim_list.setOrientation(dir);
+  m_hot.dir() = dir; 
+  m_flight.setOrientation(dir);
 }
 
 
@@ -352,23 +381,50 @@ void Bullet::UpdatePosition(const sf::Time& time) {
   float m_elapsed_time = time.asSeconds() - m_time_last;
   m_time_last = time.asSeconds();
   
-  int speed = factory::s_collection.at(m_type).speed;
-
-  float shift = m_elapsed_time * speed;
-  float dx = shift*cos((float)m_dir / 180.0 * M_PI);
-  float dy = shift*sin((float)m_dir / 180.0 * M_PI);
-  sf::Vector2f pos(m_pos);
-  pos.x += dx;
-  pos.y += dy;
+  // позиция меняется проходом EntityManager::IntegratePass
+  Wake();
+  m_hot.Move(m_elapsed_time * m_info->speed);
+}
+
+
+void Bullet::StopAt(float toi) {
+  sf::Vector2f pos(m_hot.posLast().x + (m_hot.pos().x - m_hot.posLast().x) * toi,
+                   m_hot.posLast().y + (m_hot.pos().y - m_hot.posLast().y) * toi);
   setPosition(pos);
 }
 
 
+sf::FloatRect Bullet::getBoundsAt(sf::Vector2f pos) const {
+  sf::Vector2f sz = getSize();
+  return { pos.x - sz.x / 2, pos.y - sz.y / 2, sz.x, sz.y };
+}
+
+
+sf::FloatRect Bullet::getSweptBounds() const {
+  return m_hot.getTable().getMotionBounds(m_hot.getIndex());
+}
+
+
+bool Bullet::SweptIntersects(const sf::FloatRect& target, float& toi) const {
+  return ::SweptIntersects(getBoundsAt(m_hot.posLast()), m_hot.pos() - m_hot.posLast(), target, toi);
+}
+
+
+bool Bullet::SweptIntersects(const Bullet& other, float& toi) const {
+  // движение относительно второго снаряда
+  sf::Vector2f shift = (m_hot.pos() - m_hot.posLast()) - (other.m_hot.pos() - other.m_hot.posLast());
+  return ::SweptIntersects(getBoundsAt(m_hot.posLast()), shift, 
+                           other.getBoundsAt(other.m_hot.posLast()), toi);
+}
+
+
 
 
 std::istream& operator>>(std::istream& is, BarrierTypeInfo& item) {
   is >> item.name >> item.type >> item.size.x >> item.size.y
      >> item.health >> item.obstruct_Z_eq_0 >> item.obstruct_Z_greater_0;
+  // изображение одно на подтип, экземпляры копируют его без поиска по имени
+  if (is) item.sprite = SpriteManager::Get(item.name);
   return is;
 }
 
@@ -381,25 +437,46 @@ std::ostream& operator<<(std::ostream& is, const BarrierTypeInfo& item) {
 }
 
 
-unsigned Barrier::id_cnt = 0;
-Barrier::Barrier(char type, float time) : GameEntity(), m_type(type), m_id(id_cnt++) {
-  const std::string& name = factory::s_collection.at(type).name;
-  m_sprite = SpriteManager::Get(name);
+Barrier::Barrier(World& world, const Info& info, float)
+    : GameEntity(world), m_hot(this, world.getFactory<Barrier>().getTable()),
+      m_id(world.getFactory<Barrier>().NextId()), m_type(info.type), m_info(&info),
+      m_sprite(info.sprite) {
+  m_hot.size() = info.size;
   m_sprite.setOrigin({ getSize().x / 2, getSize().y / 2 });
 }
 
+Barrier::Barrier(World& world, const Info& info, const SpawnRecord& record, float time)
+    : Barrier(world, info, time) {
+  if (record.size.x > 0 && record.size.y > 0 && record.size != info.size) {
+    m_hot.size() = record.size;
+    m_sprite.setOrigin({ record.size.x / 2, record.size.y / 2 });
+    BuildTiles();
+  }
+  m_hot.pos() = record.pos;
+  m_hot.posLast() = record.pos;
+  m_sprite.setPosition(record.pos);
+}
+
 void Barrier::Update(const sf::Time&) { 
-  m_sprite.setPosition(m_pos.x + m_local.x, m_pos.y + m_local.y);
+  m_sprite.setPosition(m_hot.pos());
 }
 
-void Barrier::Draw(sf::RenderWindow& window) {
-  window.draw(m_sprite);
+void Barrier::Capture(DrawList& list) {
+  if (m_tiles.getVertexCount() == 0) {
+    list.Add(m_sprite);
+    return;
+  }
+  sf::Transform transform;
+  transform.translate(m_hot.pos());
+  list.Add(m_tiles, m_sprite.getTexture(), transform);
 }
 
 void Barrier::Interaction(GameEntity&) {
 }
 
 void Barrier::setStateDestruction() {
+  if (m_destroyed) return;
+  Wake();
   m_destroyed = true;
 }
 
@@ -408,21 +485,51 @@ bool Barrier::isTopDrawLayer() const {
 }
 
 void Barrier::setPosition(sf::Vector2f pos) {
-  m_pos = pos;
-  //std::cout << "Local : " << m_local.x << ";  y " << m_local.y;
-  //getchar();
-  m_sprite.setPosition(pos.x + m_local.x, pos.y + m_local.y);
+  Wake();
+  m_hot.pos() = pos;
+  m_hot.posLast() = pos;
+  m_sprite.setPosition(pos);
 }
 
 sf::Vector2f Barrier::getPosition() const {
-  return m_pos;
+  return m_hot.pos();
 }
 
 sf::Vector2f Barrier::getSize() const {
-  if (m_type == 'B') {
-    
+  return m_hot.size();
+}
+
+void Barrier::setSize(sf::Vector2f size) {
+  Wake();
+  m_hot.size() = size;
+  m_sprite.setOrigin({ size.x / 2, size.y / 2 });
+  BuildTiles();
+}
+
+void Barrier::BuildTiles() {
+  m_tiles.clear();
+  sf::Vector2f cell = m_info->size;
+  if (cell.x <= 0 || cell.y <= 0) return;
+  unsigned nx = unsigned(m_hot.size().x / cell.x + 0.5f);
+  unsigned ny = unsigned(m_hot.size().y / cell.y + 0.5f);
+  if (nx * ny <= 1) return;
+  // плитки в координатах относительно центра препятствия
+  sf::FloatRect tex(m_sprite.getTextureRect());
+  m_tiles.setPrimitiveType(sf::Quads);
+  for (unsigned y = 0; y < ny; ++y) {
+    for (unsigned x = 0; x < nx; ++x) {
+      float left = x * cell.x - m_hot.size().x / 2;
+      float top = y * cell.y - m_hot.size().y / 2;
+      m_tiles.append(sf::Vertex({ left, top },
+                                { tex.left, tex.top }));
+      m_tiles.append(sf::Vertex({ left + cell.x, top },
+                                { tex.left + tex.width, tex.top }));
+      m_tiles.append(sf::Vertex({ left + cell.x, top + cell.y },
+                                { tex.left + tex.width, tex.top + tex.height }));
+      m_tiles.append(sf::Vertex({ left, top + cell.y },
+                                { tex.left, tex.top + tex.height }));
+    }
   }
-  return factory::s_collection.at(m_type).size;
 }
 
 
@@ -443,11 +550,12 @@ std::ostream& operator<<(std::ostream& is, const BonusTypeInfo& item) {
 }
 
 
-unsigned Bonus::id_cnt = 0;
-Bonus::Bonus(char type, float time) : GameEntity(), m_type(type), m_id(id_cnt++) {
-  const std::string& name = factory::s_collection.at(type).name;
+Bonus::Bonus(World& world, const Info& info, float)
+    : GameEntity(world), m_hot(this, world.getFactory<Bonus>().getTable()),
+      m_id(world.getFactory<Bonus>().NextId()), m_type(info.type), m_info(&info) {
+  m_hot.size() = info.size;
   auto& anim = m_anim_list.InsertBack(AnimList::element(new AnimBase(0)));
-  anim->setSprite(name);
+  anim->setSprite(info.name);
   if (m_type != 'f') {
     anim->setBlink(0.2, sf::Color(255, 100, 255, 100));
   }
@@ -455,14 +563,12 @@ Bonus::Bonus(char type, float time) : GameEntity(), m_type(type), m_id(id_cnt++)
 }
 
 void Bonus::Update(const sf::Time& time) {
-  //m_sprite.setPosition(m_pos.x + m_local.x, m_pos.y + m_local.y);
   m_anim_list.Update(time.asSeconds());
-  m_anim_list.setPosition(m_pos);
+  m_anim_list.setPosition(m_hot.pos());
 }
 
-void Bonus::Draw(sf::RenderWindow& window) {
-  //window.draw(m_sprite);
-  m_anim_list.Draw(window);
+void Bonus::Capture(DrawList& list) {
+  m_anim_list.Capture(list);
 }
 
 void Bonus::DestroyThis() {
@@ -473,20 +579,24 @@ void Bonus::Interaction(GameEntity&) {
 }
 
 void Bonus::setPosition(sf::Vector2f pos) {
-  m_pos = pos;
-  //m_sprite.setPosition(pos.x + m_local.x, pos.y + m_local.y);
+  Wake();
+  m_hot.pos() = pos;
+  m_hot.posLast() = pos;
 }
 
 sf::Vector2f Bonus::getPosition() const {
-  return m_pos;
+  return m_hot.pos();
 }
 
 sf::Vector2f Bonus::getSize() const {
-  return factory::s_collection.at(m_type).size;
+  return m_hot.size();
 }
 
 void Bonus::setStateDestruction() {
-  m_callback();
+  // бонус, уже полученный на этом шаге, не применяется повторно
+  if (m_destroyed) return;
+  Wake();
+  m_world.getRegistry().Defer(m_callback);
   m_destroyed = true;
 }
 
@@ -502,8 +612,8 @@ void Bonus::setDestructionCallback(std::function<void(void)> callback) {
 
 void EntityInteraction(Tank& first, Tank& second) {
   sf::FloatRect rec_sect;
-  if (first.m_state == DESTRUC || 
-      second.m_state == DESTRUC ||
+  if (first.m_hot.status() == DESTRUC || 
+      second.m_hot.status() == DESTRUC ||
       !first.getBounds().intersects(second.getBounds(), rec_sect)) {
     return;
   }
@@ -516,29 +626,28 @@ void EntityInteraction(Tank& first, Tank& second) {
   if (dir1 < -(180 - 45)) dir1 = -dir1;
   if (dir2 < -(180 - 45)) dir2 = -dir2;
   if (abs(dir1 - first.getOrientation()) <= 45 ) {
-    if(!first.isImmobile()) first.setPosition(first.m_pos_last);
+    if(!first.isImmobile()) first.setPosition(first.m_hot.posLast());
   }
   if (abs(dir2 - second.getOrientation()) <= 45 ) {
-    if (!second.isImmobile()) second.setPosition(second.m_pos_last);
+    if (!second.isImmobile()) second.setPosition(second.m_hot.posLast());
   }
 }
 
 
 void EntityInteraction(Tank& t, Bullet& b) {
-  if (t.m_state == DESTRUC || 
-      t.m_state == BIRTH ||
-      b.m_state == DESTRUC ||
-      !t.getBounds().intersects(b.getBounds())) {
+  float toi;
+  if (t.m_hot.status() == DESTRUC || 
+      t.m_hot.status() == BIRTH ||
+      b.m_hot.status() == DESTRUC ||
+      !b.SweptIntersects(t.getBounds(), toi)) {
     return;
   }
   //std::cout << "Interaction: tank bullet" << std::endl;
 
-  if (t.m_type != 'e' && b.m_type == 'S') {
-    t.setStateDestruction();
-    b.setStateDestruction();
-  } 
-  else if(t.m_type == 'e' && b.m_type != 'S') {
+  // снаряды не поражают танки своей стороны
+  if (t.m_hot.faction() != b.m_hot.faction()) {
     t.setStateDestruction();
+    b.StopAt(toi);
     b.setStateDestruction();
   }
 }
@@ -546,44 +655,48 @@ void EntityInteraction(Tank& t, Bullet& b) {
 
 void EntityInteraction(Tank& t, Barrier& b) {
   sf::FloatRect rec_sect;
-  if (!t.getBounds().intersects(b.getBounds(), rec_sect)) return;
+  if (b.isDestroyed() || !t.getBounds().intersects(b.getBounds(), rec_sect)) return;
   // смотрим у разделяемых данных препятствий, можно ли проехать через это препятствие?
-  const auto& item = Barrier::factory::s_collection.at(b.m_type);
-  if (item.obstruct_Z_eq_0 == 1) return;
+  if (b.m_info->obstruct_Z_eq_0 == 1) return;
   //std::cout << "Interaction: tank barrier  " << std::endl;
   sf::Vector2f new_pos(t.getPosition());
-  new_pos.x -= rec_sect.width  * cos((float)t.m_dir / 180.0f * M_PI);
-  new_pos.y -= rec_sect.height * sin((float)t.m_dir / 180.0f * M_PI);
+  new_pos.x -= rec_sect.width  * cos((float)t.m_hot.dir() / 180.0f * M_PI);
+  new_pos.y -= rec_sect.height * sin((float)t.m_hot.dir() / 180.0f * M_PI);
   t.setPosition(new_pos);
 }
 
 
 void EntityInteraction(Tank& t, Bonus& b) {
   sf::FloatRect rec_sect;
-  if (!t.getBounds().intersects(b.getBounds(), rec_sect)) return;
+  if (b.isDestroyed() || !t.getBounds().intersects(b.getBounds(), rec_sect)) return;
   //std::cout << "Interaction: tank bonus" << std::endl;
-  if (t.m_type == 'e') {
+  if (t.m_hot.faction() == Faction::PLAYER) {
     b.setStateDestruction();
   }
 }
 
 
 void EntityInteraction(Bullet& b1, Bullet& bul2) {
-  if (b1.m_state == DESTRUC || bul2.m_state == DESTRUC) return;
-  if (!b1.getBounds().intersects(bul2.getBounds())) return;
+  float toi;
+  if (b1.m_hot.status() == DESTRUC || bul2.m_hot.status() == DESTRUC) return;
+  if (!b1.SweptIntersects(bul2, toi)) return;
   //std::cout << "Interaction: bullet bullet" << std::endl;
   using namespace std;
+  bul2.StopAt(toi);
+  b1.StopAt(toi);
   bul2.setStateDestruction();
   b1.setStateDestruction();
 }
 
 
 void EntityInteraction(Bullet& bullet, Barrier& barrier) {
-  if (bullet.m_state == DESTRUC ||
-    !bullet.getBounds().intersects(barrier.getBounds())) {
+  float toi;
+  if (bullet.m_hot.status() == DESTRUC || barrier.isDestroyed() ||
+    !bullet.SweptIntersects(barrier.getBounds(), toi)) {
     return;
   }
   if (barrier.m_type == 'V' || barrier.m_type == 'H') {
+    bullet.StopAt(toi);
     bullet.setStateDestruction();
   }
   else {
@@ -593,10 +706,12 @@ void EntityInteraction(Bullet& bullet, Barrier& barrier) {
     switch (barrier.m_type)
     {
     case '-':
+      bullet.StopAt(toi);
       bullet.setStateDestruction();
       barrier.setStateDestruction();
       break;
     case '=':
+      bullet.StopAt(toi);
       bullet.setStateDestruction();
       break;
     default:
@@ -606,11 +721,13 @@ void EntityInteraction(Bullet& bullet, Barrier& barrier) {
 }
 
 void EntityInteraction(Bullet& bullet, Bonus& bonus) {
-  if (bullet.m_state == DESTRUC ||
-      !bullet.getBounds().intersects(bonus.getBounds())) {
+  float toi;
+  if (bullet.m_hot.status() == DESTRUC || bonus.isDestroyed() ||
+      !bullet.SweptIntersects(bonus.getBounds(), toi)) {
     return;
   }
   if (bonus.m_type == 'f') {
+      bullet.StopAt(toi);
       bullet.setStateDestruction();
       bonus.setStateDestruction();
   }
@@ -644,43 +761,44 @@ void test_factory_create()
   using namespace std;
   cout << "start game entity creating :" << endl;
 
-  SharedContext(R"(..\resources\paths.cfg)");
+  SharedContext("../resources/paths.cfg");
 
   SpriteSheetInfo::LoadSpriteSheetInfo(SharedContext::getFilePath("SpriteSheet"));
 
-  Tank::factory::LoadCollection(SharedContext::getFilePath("Tanks"));
-  Tank::factory::Create('a', 0);
-  Tank::factory::Create('b', 0);
-  Tank::factory::Create('c', 0);
-  Tank::factory::Create('d', 0);
+  World world;
+  world.getFactory<Tank>().LoadCollection(SharedContext::getFilePath("Tanks"));
+  world.getFactory<Tank>().Create('a', 0);
+  world.getFactory<Tank>().Create('b', 0);
+  world.getFactory<Tank>().Create('c', 0);
+  world.getFactory<Tank>().Create('d', 0);
   cout << "Tanks create" << endl;
 
-  Bullet::factory::LoadCollection(SharedContext::getFilePath("Bullet"));
-  Bullet::factory::Create('A', 0);
-  Bullet::factory::Create('B', 0);
-  Bullet::factory::Create('C', 0);
-  Bullet::factory::Create('D', 0);
+  world.getFactory<Bullet>().LoadCollection(SharedContext::getFilePath("Bullet"));
+  world.getFactory<Bullet>().Create('A', 0);
+  world.getFactory<Bullet>().Create('B', 0);
+  world.getFactory<Bullet>().Create('C', 0);
+  world.getFactory<Bullet>().Create('D', 0);
   cout << "Bullets create" << endl;
 
-  Barrier::factory::LoadCollection(SharedContext::getFilePath("Barrier"));
-  Barrier::factory::Create('-', 0);
-  Barrier::factory::Create('+', 0);
-  Barrier::factory::Create('*', 0);
-  Barrier::factory::Create('/', 0);
-  Barrier::factory::Create('=', 0);
+  world.getFactory<Barrier>().LoadCollection(SharedContext::getFilePath("Barrier"));
+  world.getFactory<Barrier>().Create('-', 0);
+  world.getFactory<Barrier>().Create('+', 0);
+  world.getFactory<Barrier>().Create('*', 0);
+  world.getFactory<Barrier>().Create('/', 0);
+  world.getFactory<Barrier>().Create('=', 0);
   cout << "Barriers create" << endl;
 
-  Bonus::factory::LoadCollection(SharedContext::getFilePath("Bonus"));
-  Bonus::factory::Create('c', 0);
-  Bonus::factory::Create('b', 0);
-  Bonus::factory::Create('s', 0);
-  Bonus::factory::Create('t', 0);
-  Bonus::factory::Create('h', 0);
-  Bonus::factory::Create('w', 0);
-  Bonus::factory::Create('f', 0);
+  world.getFactory<Bonus>().LoadCollection(SharedContext::getFilePath("Bonus"));
+  world.getFactory<Bonus>().Create('c', 0);
+  world.getFactory<Bonus>().Create('b', 0);
+  world.getFactory<Bonus>().Create('s', 0);
+  world.getFactory<Bonus>().Create('t', 0);
+  world.getFactory<Bonus>().Create('h', 0);
+  world.getFactory<Bonus>().Create('w', 0);
+  world.getFactory<Bonus>().Create('f', 0);
   cout << "Bonus create" << endl;
 
-  GameEntity::g_entity_list.clear();
+  world.Clear();
 
   cout << "after clearing" << endl;
   getchar();
@@ -694,37 +812,38 @@ void test_factory_loading() {
   using namespace std;
   cout << "start:" << endl;
   getchar();
+  World world;
 
   // tanks
   string file1 = R"(entity_info\tanks.cfg)";
   cout << file1 << endl;
-  Tank::factory::LoadCollection(file1); 
-  for (auto item : Tank::factory::s_collection) {
-    cout << item.second << endl;
+  world.getFactory<Tank>().LoadCollection(file1); 
+  for (const auto& item : world.getFactory<Tank>().getCollection()) {
+    cout << item << endl;
   }
 
   // 
   string file2 = R"(entity_info\bullet.cfg)";
   cout << file1 << endl;
-  Bullet::factory::LoadCollection(file2);
-  for (auto item : Bullet::factory::s_collection) {
-    cout << item.second << endl;
+  world.getFactory<Bullet>().LoadCollection(file2);
+  for (const auto& item : world.getFactory<Bullet>().getCollection()) {
+    cout << item << endl;
   }
 
   // 
   string file3 = R"(entity_info\barrier.cfg)";
   cout << file3 << endl;
-  Barrier::factory::LoadCollection(file3);
-  for (auto item : Barrier::factory::s_collection) {
-    cout << item.second << endl;
+  world.getFactory<Barrier>().LoadCollection(file3);
+  for (const auto& item : world.getFactory<Barrier>().getCollection()) {
+    cout << item << endl;
   }
 
   // 
   string file4 = R"(entity_info\bonus.cfg)";
   cout << file4 << endl;
-  Bonus::factory::LoadCollection(file4);
-  for (auto item : Bonus::factory::s_collection) {
-    cout << item.second << endl;
+  world.getFactory<Bonus>().LoadCollection(file4);
+  for (const auto& item : world.getFactory<Bonus>().getCollection()) {
+    cout << item << endl;
   }
 
   cout << "end" << endl;
@@ -8,6 +8,7 @@
 #include <iomanip>
 
 #include <vector>
+#include <array>
 #include <list>
 #include <unordered_map>
 #include <memory>
@@ -16,10 +17,14 @@
 #include <stdexcept>
 #include <cmath>
 #include <cstdlib>
+#include <limits>
+#include <algorithm>
 
 #include "SFML\Graphics.hpp"
 
 #include "EntityBase.h"
+#include "Components.h"
+#include "Random.h"
 #include "SpriteManager.h"
 #include "Animating.h"
 
@@ -31,24 +36,6 @@ class Barrier;
 class Bonus;
 class TankDriverBase;
 
-/// направления, доступные для юнитов
-// явно продублирован знаковый тип значений,
-// угол [0 .. 180, 0 ..-180], знак + от оси X к Y
-enum direction : int { 
-  FORWD = -90,
-  RIGHT = 0,
-  BACK = 90, 
-  LEFT = 180 
-};
-
-/// состояние отображения
-enum state { 
-  BIRTH = 1,  ///< появление 
-  ACTIVE = 2, ///< действие
-  DESTRUC = 3 ///< уничтожение
-};
-
-
 /// \brief разделяемая информация для подтипов экземпляров класса Tank
 /// \see Factory
 struct TankTypeInfo {
@@ -78,7 +65,7 @@ std::ostream& operator<<(std::ostream& is, const TankTypeInfo& item);
 /// 
 /// Коллекция подтипов: 
 /// \include ..\resources\tanks.cfg
-class Tank : public GameEntity {
+class Tank final : public GameEntity {
   /// состояния от воздействия бонусов
   enum tank_state {
     NORMAL = 0,    ///< cтандартное 
@@ -91,24 +78,30 @@ class Tank : public GameEntity {
   using factory = Factory<Tank, TankTypeInfo>;      ///< класс, управляющи созданием и размещением 
   using iterator = factory::iterator;               ///< тип косвенного доступа
   friend factory; // локализует создание экземпляров
+
+  /// наибольшее количество летящих снарядов одного танка
+  static const int kBulletsMax = 2;
   
   void Interaction(GameEntity&)  override;
   void Update(const sf::Time& time)  override;
-  void Draw(sf::RenderWindow& window)  override;
+  void Capture(DrawList& list)  override;
   bool isDestroyed() const override { return m_destroyed; }
   bool isImmobile() const { return !bool(m_move_delay); } ///< индикатор неподвижности
   
   void setPosition(sf::Vector2f )    override;
   void setOrientation(direction);                    ///< задать направление
   sf::Vector2f getPosition()  const override;
-  direction   getOrientation() const { return m_dir; }
+  direction   getOrientation() const { return m_hot.dir(); }
   sf::Vector2f getSize()    const override;
 
+  /// область, покрывающая прошлую и текущую позиции танка
+  sf::FloatRect getMotionBounds() const;
+
   void Left();                      ///< перемешение
   void Ridht();                     ///< перемешение
   void Forward();                   ///< перемешение
   void Back();                      ///< перемешение
-  void Fire();                      ///< стрельба
+  void Fire();                      ///< стрельба (не более kBulletsMax снарядов в полете)
 
   /// переводит \a стретегию поведения в автономный режим по умолчанию
   void setAutoPilot( );
@@ -132,22 +125,23 @@ class Tank : public GameEntity {
   friend void EntityInteraction(Tank&, Bonus&);
 
  private:
-  /// \param type подтип 
+  /// \param world мир, которому принадлежит танк
+  /// \param info параметры подтипа (запись набора Factory::getCollection)
   /// \param time время создания
-  Tank(char type, float time);
+  Tank(World& world, const Info& info, float time);
 
   void setStateActiveNormal();              ///< переводит в активное нормальное состояние
   void UpdateActiveState( );
-  void UpdatePosition( );                   ///< переместить юнит и анимацию
+  void UpdatePosition( );                   ///< задает перемещение на шаге (ComponentRow::Move)
 
   std::unique_ptr<TankDriverBase> m_Driver;        ///< стратегия поведения
   
-  sf::Vector2f m_pos;                       ///< координаты на игровом поле
-  sf::Vector2f m_pos_last;                  ///< позиция до обновления
+  /// позиция, позиция до обновления, размер, направление, состояние и сторона
+  ComponentRow<Tank> m_hot;
 
-  direction m_dir = FORWD;                  ///< направление движения
   const int m_id;                           ///< уникальный номер экземпляра
   char      m_type;                         ///< подтип (\ref Factory::LoadCollection)
+  const Info* m_info;                       ///< разделяемые параметры подтипа
   AnimList  m_anim_list;                    ///< слои анимации
   float     m_elepsed_time = 0;             ///< время жизни с момента создания
   float     m_time_last = 0;                ///< время последнего обновления
@@ -156,11 +150,10 @@ class Tank : public GameEntity {
   int       m_move_delay = 0;               ///< индикатор движения
   bool      m_move_flag = false;            ///< нажатие на газ
   bool      m_destroyed = false;            ///< готовность к удалению объекта
-  state     m_state;                      
   tank_state m_tank_state = NORMAL;          
   std::function<void(void)> m_callback;     ///< вызывается при уничтожении
-  
-  static unsigned id_cnt;                   ///< отсчитывает уникальные номера
+  /// выпущенные снаряды (ссылка на удаленный снаряд недействительна)
+  std::array<SlotMap<Bullet>::Handle, kBulletsMax> m_bullets;
 };
 
 
@@ -182,11 +175,13 @@ class TankDriverBase {
 /// \brief Стратегия автономного поведения Tank по умолчанию
 class TankDriver : public TankDriverBase {
  public:
-  TankDriver(Tank& tank);
+  /// \param random генератор случайных чисел мира танка
+  TankDriver(Tank& tank, Random& random);
   void ApplyControl(float ) override;
   direction getRandomDir();               ///< генерирует случайное направление
  
  private:
+  Random&       m_random;
   sf::Vector2f  m_pos;                    ///< прошлая позиция 
   direction     m_dir;
   const float   delta = 0.0001;           ///< критерий перемещения
@@ -215,10 +210,14 @@ std::ostream& operator<<(std::ostream& is, const BulletTypeInfo& item);
 /// Имеет подтипы, указанные в члене-данных char type_
 ///   подтип определяет параметры BulletTypeInfo включенные в состав объекта, как разделяемые данные.
 ///
+/// Анимации полета и разрыва хранятся в самом снаряде, а снаряды размещаются
+///   в заранее выделенных ячейках хранилища (Factory::Reserve), которые занимаются
+///   повторно. Поэтому выстрелы и разрывы не выделяют память.
+///
 /// Пример конфигурационного файла подтипов снаряда:
 /// \include ..\resources\bullet.cfg
 /// \see Tank::Fire
-class Bullet : public GameEntity {
+class Bullet final : public GameEntity {
  public:
   using Info = BulletTypeInfo;                    ///< \copydoc Tank::Info
   using factory = Factory<Bullet, Info>;          ///< \copydoc Tank::factory
@@ -227,7 +226,7 @@ class Bullet : public GameEntity {
 
   void Interaction(GameEntity&)  override;
   void Update(const sf::Time& )  override;
-  void Draw(sf::RenderWindow& window) override;
+  void Capture(DrawList& list) override;
   bool isDestroyed() const override { return m_destroyed; }
 
   void setPosition(sf::Vector2f pos) override;
@@ -236,6 +235,21 @@ class Bullet : public GameEntity {
 
   void setStateDestruction( );                    ///< \copydoc Tank::setStateDestruction
   void setDirection(direction);
+  bool isFlying() const { return m_hot.status() == ACTIVE; }  ///< снаряд еще не разорвался
+
+  /// задает выпустивший снаряд танк и его сторону
+  void setOwner(int id, Faction faction);
+
+  /// область, заметаемая снарядом за последнее перемещение
+  sf::FloatRect getSweptBounds() const;
+
+  /// проверка пересечения с неподвижной областью в ходе последнего перемещения
+  /// \param toi доля перемещения [0..1] до момента первого касания
+  bool SweptIntersects(const sf::FloatRect& target, float& toi) const;
+
+  /// проверка пересечения с другим снарядом с учетом перемещения обоих
+  /// \param toi доля перемещения [0..1] до момента первого касания
+  bool SweptIntersects(const Bullet& other, float& toi) const;
 
   // данные открываются для обработки взаимодействий
   friend void EntityInteraction(Tank&, Bullet&);
@@ -245,19 +259,21 @@ class Bullet : public GameEntity {
 
  private:
   /// \copydoc Tank::Tank
-  Bullet(char type, float time);
+  Bullet(World& world, const Info& info, float time);
   /// \copydoc Tank::UpdatePosition
   void UpdatePosition(const sf::Time&);
-  sf::Vector2f  m_pos;                          ///< координаты на игровом поле
+  /// возвращает снаряд в точку касания
+  /// \param toi доля последнего перемещения
+  void StopAt(float toi);
+  sf::FloatRect getBoundsAt(sf::Vector2f pos) const;
+  ComponentRow<Bullet> m_hot;                   ///< \copydoc Tank::m_hot
   const int     m_id;                           ///< уникальный номер экземпляра
   const char    m_type;                         ///< подтип (\ref Factory::LoadCollection)
-  AnimList      m_anim_list;                    ///< слои анимации
-  direction     m_dir = FORWD;                  ///< направление движения
+  const Info*   m_info;                         ///< \copydoc Tank::m_info
+  AnimBase      m_flight;                       ///< отображение в полете
+  AnimSingle    m_bang;                         ///< отображение разрыва
   float         m_time_last = 0;                ///< время последнего обновления
   bool          m_destroyed = false;            ///< готовность к удалению объекта
-  state         m_state;
-
-  static unsigned id_cnt;                       ///< отсчитывает уникальные номера
 };
 
 
@@ -270,6 +286,7 @@ struct BarrierTypeInfo {
   int health = 0;                               ///< здоровье
   bool obstruct_Z_eq_0 = 0;                     ///< преграждает путь объектам с нулевой высотой
   bool obstruct_Z_greater_0 = 0;                ///< преграждает путь летящим объектам
+  sf::Sprite sprite;                            ///< изображение подтипа (по имени, при загрузке)
 };
 
 std::istream& operator>>(std::istream& is, BarrierTypeInfo& item);
@@ -285,7 +302,7 @@ std::ostream& operator<<(std::ostream& is, const BarrierTypeInfo& item);
 ///
 /// Пример конфигурационного файла видов препятствий:
 /// \include ..\resources\barrier.cfg
-class Barrier : public GameEntity {
+class Barrier final : public GameEntity {
  public:
   using Info = BarrierTypeInfo;                   ///< \copydoc Tank::Info
   using factory = Factory<Barrier, Info>;         ///< \copydoc Tank::factory
@@ -293,27 +310,42 @@ class Barrier : public GameEntity {
   friend factory;
   
   void Update(const sf::Time&)        override;
-  void Draw(sf::RenderWindow& window) override;
+  void Capture(DrawList& list) override;
   void Interaction(GameEntity&)       override;
   bool isDestroyed() const            override { return m_destroyed; }
   void setStateDestruction();                     ///< \copydoc Tank::setDestruction
   bool isTopDrawLayer() const;                    ///< отображается поверх основной сцены
+  char getType() const { return m_type; }         ///< подтип (\ref Factory::LoadCollection)
+  const Info& getInfo() const { return *m_info; } ///< разделяемые параметры подтипа
+
+  /// подтип разрушается снарядами (EntityInteraction(Bullet&, Barrier&))
+  static bool isDestructible(char type) { return type == '-'; }
 
   void  setPosition(sf::Vector2f pos) override;
   sf::Vector2f getPosition()    const override;
   sf::Vector2f getSize()        const override;
+
+  /// \brief задает размер объединенного препятствия, кратный размеру подтипа.
+  /// Препятствие отображается плитками спрайта подтипа за один вызов отрисовки.
+  /// \see BattleCity::CreateMapBarriers
+  void setSize(sf::Vector2f size);
   
   friend void EntityInteraction(Tank&, Barrier&);
   friend void EntityInteraction(Bullet&, Barrier&);
 private:
   ///< \copydoc Tank::Tank
-  Barrier(char type, float time = 0);
-  sf::Vector2f  m_pos;                           ///< координаты на игровом поле
+  Barrier(World& world, const Info& info, float time = 0);
+  /// создает препятствие сразу с позицией и размером записи (Factory::CreateBatch)
+  Barrier(World& world, const Info& info, const SpawnRecord& record, float time);
+  /// строит плитки объединенного препятствия
+  void BuildTiles();
+  ComponentRow<Barrier> m_hot;                   ///< координаты и размер области
+  sf::VertexArray m_tiles;                       ///< плитки объединенного препятствия (пусто - спрайт)
   const int     m_id;                            ///< уникальный номер экземпляра
   const char    m_type;                          ///< подтип (\ref Factory::LoadCollection)
+  const Info*   m_info;                          ///< \copydoc Tank::m_info
   sf::Sprite    m_sprite;                        ///< графическое представление
   bool          m_destroyed = false;             ///< готовность к удалению объекта
-  static unsigned id_cnt;
 };
 
 
@@ -337,7 +369,7 @@ std::ostream& operator<<(std::ostream& is, const BonusTypeInfo& item);
 /// 
 /// Пример конфигурационного файла видов препятствий:
 /// \include ..\resources\bonus.cfg
-class Bonus : public GameEntity {
+class Bonus final : public GameEntity {
 public:
   using Info = BonusTypeInfo;                     ///< \copydoc Tank::Info
   using factory = Factory<Bonus, Info>;           ///< \copydoc Tank::factory
@@ -346,7 +378,7 @@ public:
 
   void Interaction(GameEntity&)       override;
   void Update(const sf::Time&)        override;
-  void Draw(sf::RenderWindow& window) override;
+  void Capture(DrawList& list) override;
   bool isDestroyed() const override { return m_destroyed; }
   void DestroyThis();
 
@@ -362,16 +394,15 @@ public:
   friend void EntityInteraction(Bullet&, Bonus&);
 private:
   /// \copydoc Tank::Tank
-  Bonus(char type, float time = 0);
-  sf::Vector2f    m_pos;                     ///< координаты на игровом поле
+  Bonus(World& world, const Info& info, float time = 0);
+  ComponentRow<Bonus> m_hot;                 ///< координаты и размер области
   const int       m_id;                      ///< уникальный номер экземпляра
   const char      m_type;                    ///< подтип (\ref Factory::LoadCollection)
+  const Info*     m_info;                    ///< \copydoc Tank::m_info
   sf::Sprite      m_sprite;                  ///< слои анимации
   AnimList        m_anim_list;               ///< слои анимации
   bool            m_destroyed = false;       ///< готовность к удалению объекта
   std::function<void(void)> m_callback;      ///< вызывается при уничтожении
-
-  static unsigned id_cnt;
 };
 
 
@@ -400,6 +431,88 @@ inline sf::Vector2f MovingShift2D(float time, float speed, float angle) {
   return sf::Vector2f(dx, dy);
 }
 
+/// \brief проверка пересечения движущейся области с неподвижной (метод разделяющих осей по времени)
+/// \param moving  область в начале перемещения
+/// \param shift   перемещение за шаг
+/// \param target  неподвижная область
+/// \param toi     доля перемещения [0..1] до первого касания
+/// Условие касания строгое, как в sf::Rect::intersects. При нулевом перемещении
+/// совпадает с проверкой пересечения областей.
+inline bool SweptIntersects(const sf::FloatRect& moving, sf::Vector2f shift,
+                            const sf::FloatRect& target, float& toi) {
+  float lo = -std::numeric_limits<float>::max();
+  float hi = std::numeric_limits<float>::max();
+  const float m_min[2] = { moving.left, moving.top };
+  const float m_max[2] = { moving.left + moving.width, moving.top + moving.height };
+  const float t_min[2] = { target.left, target.top };
+  const float t_max[2] = { target.left + target.width, target.top + target.height };
+  const float s[2] = { shift.x, shift.y };
+  for (int a = 0; a < 2; ++a) {
+    if (s[a] == 0) {
+      if (!(m_min[a] < t_max[a] && t_min[a] < m_max[a])) return false;
+      continue;
+    }
+    float t0 = (t_min[a] - m_max[a]) / s[a];
+    float t1 = (t_max[a] - m_min[a]) / s[a];
+    if (t0 > t1) std::swap(t0, t1);
+    lo = std::max(lo, t0);
+    hi = std::min(hi, t1);
+  }
+  if (!(lo < hi && lo < 1 && hi > 0)) return false;
+  toi = std::max(lo, 0.0f);
+  return true;
+}
+
+/// область, по которой юнит отбирается для проверки взаимодействий
+inline sf::FloatRect BroadBounds(const GameEntity& item) { return item.getBounds(); }
+
+/// снаряд отбирается по всей области, заметаемой за шаг
+inline sf::FloatRect BroadBounds(const Bullet& item) { return item.getSweptBounds(); }
+
+/// танк отбирается с учетом возврата на прошлую позицию при столкновениях
+inline sf::FloatRect BroadBounds(const Tank& item) { return item.getMotionBounds(); }
+
+/// \brief область юнита, по которой NarrowTest проверяет его пару с \a other:
+/// BroadBounds, а для цели снаряда - область экземпляра
+template <typename T, typename U>
+sf::FloatRect NarrowBounds(const T& item, const U&) { return BroadBounds(item); }
+
+/// \copydoc NarrowBounds
+template <typename T>
+sf::FloatRect NarrowBounds(const T& item, const Bullet&) { return item.getBounds(); }
+
+/// \brief проверка пары, выполняемая до вызова EntityInteraction (EntityManager::NarrowPhase).
+/// Области участников NarrowBounds передаются параметрами: NarrowPhase берет их из кэшей,
+/// записанных при отборе пар, не обращаясь к экземплярам. Только читает состояние юнитов.
+/// По умолчанию сравниваются области, окончательную проверку выполняет EntityInteraction.
+/// \param toi доля перемещения снаряда до касания (0 для пар без снарядов)
+template <typename T1, typename T2>
+bool NarrowTest(const T1&, const sf::FloatRect& first_bounds,
+                const T2&, const sf::FloatRect& second_bounds, float& toi) {
+  toi = 0;
+  return first_bounds.intersects(second_bounds);
+}
+
+/// снаряд проверяется на всем отрезке перемещения
+template <typename T1>
+bool NarrowTest(const T1&, const sf::FloatRect& first_bounds,
+                const Bullet& bullet, const sf::FloatRect&, float& toi) {
+  return bullet.SweptIntersects(first_bounds, toi);
+}
+
+/// \copydoc NarrowTest(const T1&, const sf::FloatRect&, const Bullet&, const sf::FloatRect&, float&)
+template <typename T2>
+bool NarrowTest(const Bullet& bullet, const sf::FloatRect&,
+                const T2&, const sf::FloatRect& second_bounds, float& toi) {
+  return bullet.SweptIntersects(second_bounds, toi);
+}
+
+/// снаряды проверяются с учетом перемещения обоих
+inline bool NarrowTest(const Bullet& first, const sf::FloatRect&,
+                       const Bullet& second, const sf::FloatRect&, float& toi) {
+  return first.SweptIntersects(second, toi);
+}
+
 inline void PrintVector(const sf::Vector2f& v) {
   using namespace std;
   cout << "x : " << v.x << ";\ty : " << v.y << endl;
@@ -412,24 +525,5 @@ inline void PrintRec(const sf::FloatRect& rec) {
 }
 
 
-inline void printEntityStatistics(const std::string& label) {
-  /* выводи состав хранилищ юнитов
-  using namespace std;
-  cout << endl << label << endl;
-  cout << "Statistics : " << endl;
-  cout << "GameEntity::g_entity_list.size() \t: " << GameEntity::g_entity_list.size() << endl;
-  cout << "tanks \t\t: "  << Tank::factory::s_current_set.size() << endl;
-  cout << "bullets \t: "  << Bullet::factory::s_current_set.size() << endl;
-  cout << "barriers \t: " << Barrier::factory::s_current_set.size() << endl;
-  cout << "bonus \t\t: "  << Bonus::factory::s_current_set.size() << endl;
-
-  cout << "\n collection tanks \t: "  << Tank::factory::s_collection.size() << endl;
-  cout << "collection bullets \t: "  << Bullet::factory::s_collection.size() << endl;
-  cout << "collection barriers \t: "  << Barrier::factory::s_collection.size() << endl;
-  cout << "collection bonus \t: "    << Bonus::factory::s_collection.size() << endl;
-  */
-}
-
-
 // tests
 void test_factory_battle_city();
@@ -39,11 +39,22 @@ void Window::Create() {
     sf::VideoMode(m_windowSize.x,m_windowSize.y,32), 
     m_windowTitle,
     style);
+  // окно пересоздается при смене полноэкранного режима
+  m_window.setVerticalSyncEnabled(m_pacer.getMode() == FramePacer::Mode::VSYNC);
 }
 
 void Window::BeginDraw()    { m_window.clear(sf::Color::Black); }
 
-void Window::EndDraw()    { m_window.display(); }
+void Window::EndDraw() {
+  m_window.display();
+  m_pacer.EndFrame();
+}
+
+void Window::SetFramePacing(FramePacer::Mode mode, float fps) {
+  if (mode == FramePacer::Mode::TARGET_FPS) m_pacer.setTargetFps(fps);
+  else                                       m_pacer.setMode(mode);
+  m_window.setVerticalSyncEnabled(mode == FramePacer::Mode::VSYNC);
+}
 
 bool Window::IsDone()    { return m_isDone; }
 
@@ -55,6 +66,8 @@ sf::RenderWindow* Window::GetRenderWindow()  { return &m_window; }
 
 EventManager* Window::GetEventManager()  { return &m_eventManager; }
 
+FramePacer* Window::GetFramePacer()  { return &m_pacer; }
+
 sf::Vector2u Window::GetWindowSize()    { return m_windowSize; }
 
 
@@ -82,6 +95,5 @@ void Window::Update() {
     m_eventManager.HandleEvent(event);
   }
   m_eventManager.Update();
-  sf::sleep(sf::seconds(1.0/120.0));
 }
 
@@ -7,6 +7,7 @@
 #include <SFML/System.hpp>
 #include <SFML/Graphics.hpp>
 #include "EventManager.h"
+#include "FramePacer.h"
 
 /// \brief Абстракция графического окна ОС. 
 /// 
@@ -15,7 +16,8 @@
 /// разворачивание, закрытие, отслеживание фокуса мыши, начало и конец отображения
 /// графики, обновление программы и изображения,
 /// обработку событий пользовательского ввода при помощи EventManager.
-/// \see EventManager
+/// Частота кадров ограничивается FramePacer после отображения кадра (EndDraw).
+/// \see EventManager, FramePacer
 class Window {
  public:
   Window();
@@ -23,6 +25,7 @@ class Window {
   ~Window();
 
   void BeginDraw();
+  /// выводит кадр и ожидает остаток его бюджета (FramePacer::EndFrame)
   void EndDraw();
 
   void Update();
@@ -37,7 +40,12 @@ class Window {
   /// Закрыть окно и завершить программу
   void Close(EventDetails* l_details = nullptr);
 
+  /// \brief задает ограничение частоты кадров (режимы могут задавать свой бюджет)
+  /// \param fps частота кадров режима FramePacer::Mode::TARGET_FPS
+  void SetFramePacing(FramePacer::Mode mode, float fps = FramePacer::kDefaultFps);
+
   sf::RenderWindow* GetRenderWindow();
+  FramePacer*       GetFramePacer();
   EventManager*     GetEventManager();
   sf::Vector2u      GetWindowSize();
 
@@ -48,6 +56,7 @@ class Window {
 
   sf::RenderWindow  m_window;                      ///< экземпляр окна
   EventManager      m_eventManager;                ///< обрабочик событий пользовательского ввода
+  FramePacer        m_pacer;                       ///< ограничение частоты кадров
   sf::Vector2u      m_windowSize;
   std::string       m_windowTitle;
   bool              m_isDone;
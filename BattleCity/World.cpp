@@ -0,0 +1,13 @@
+#include "World.h"
+
+void World::Clear() {
+  m_registry.clear();
+  ForEachType(EntityTypes(), [this](auto tag) {
+    using T = typename decltype(tag)::type;
+    getFactory<T>().getCurrentSet().clear();
+  });
+  ForEachType(EntityTypes(), [this](auto tag) {
+    using T = typename decltype(tag)::type;
+    getFactory<T>().setCollection(nullptr);
+  });
+}
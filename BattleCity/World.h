@@ -0,0 +1,127 @@
+/// \file
+/// \ingroup battle_city_game_classes
+#pragma once
+
+#include <string>
+#include <iostream>
+#include <cstdint>
+
+#include "EntityBase.h"
+#include "EntityRegistry.h"
+#include "Units.h"
+#include "EntityTypes.h"
+#include "Random.h"
+
+
+/// \brief хранилище Factory типа T в составе World
+template <typename T>
+struct FactoryHolder {
+  FactoryHolder(World& world, EntityRegistry& registry) : factory(world, registry) {}
+  typename T::factory factory;
+};
+
+/// \brief набор хранилищ Factory для всех типов списка
+template <typename List>
+class FactorySet;
+
+template <typename... Ts>
+class FactorySet<TypeList<Ts...>> : private FactoryHolder<Ts>... {
+ public:
+  FactorySet(World& world, EntityRegistry& registry) : FactoryHolder<Ts>(world, registry)... {}
+
+  template <typename T>
+  typename T::factory& get() { return static_cast<FactoryHolder<T>&>(*this).factory; }
+
+  template <typename T>
+  const typename T::factory& get() const {
+    return static_cast<const FactoryHolder<T>&>(*this).factory;
+  }
+};
+
+
+/// \brief Игровой мир: все экземпляры игровых сущностей одной битвы и их учет
+///
+/// Владеет хранилищами и наборами подтипов всех типов EntityTypes (Factory),
+/// реестром экземпляров (EntityRegistry) и счетчиком обработок взаимодействий.
+/// Экземпляры GameEntity, BattleCity, GameScenario и EntityManager получают мир явно,
+/// поэтому миры не разделяют изменяемых данных и в одном процессе может одновременно
+/// существовать несколько независимых битв (каждая обрабатывается одним потоком).
+/// Общими для всех миров остаются только загружаемые ресурсы отображения
+/// (SpriteManager, SpriteSheetInfo).
+/// Случайные решения битвы принимаются только генератором мира (getRandom),
+/// а время битвы задается вызывающим (BattleCity::Update), поэтому битва
+/// детерминирована зерном и командами управления.
+/// \see Factory, BattleCity
+class World {
+ public:
+  /// \param seed зерно генератора случайных чисел мира
+  explicit World(std::uint64_t seed = Random::kDefaultSeed)
+      : m_random(seed), m_factories(*this, m_registry) {}
+  World(const World&) = delete;
+  World& operator=(const World&) = delete;
+  ~World() { Clear(); }
+
+  /// хранилище экземпляров типа T
+  template <typename T>
+  typename T::factory& getFactory() { return m_factories.template get<T>(); }
+
+  template <typename T>
+  const typename T::factory& getFactory() const { return m_factories.template get<T>(); }
+
+  /// параметры подтипа \a type типа T
+  /// \throw std::out_of_range подтип не загружен
+  template <typename T>
+  const typename T::Info& getInfo(char type) const {
+    return getFactory<T>().getCollection().at(type);
+  }
+
+  /// реестр "живущих" экземпляров всех типов
+  EntityRegistry& getRegistry()             { return m_registry; }
+  const EntityRegistry& getRegistry() const { return m_registry; }
+
+  /// номер текущей обработки взаимодействий (EntityManager::Interaction)
+  unsigned getStep() const { return m_step; }
+  void NextStep() { ++m_step; }
+
+  /// генератор случайных чисел мира
+  Random& getRandom() { return m_random; }
+
+  /// удаляет все экземпляры и освобождает наборы подтипов всех типов
+  /// \see BattleCity::Stop
+  void Clear();
+
+ private:
+  EntityRegistry          m_registry;     ///< создается раньше хранилищ, регистрирующихся в нем
+  unsigned                m_step = 0;
+  Random                  m_random;       ///< случайные решения сценария и автопилотов
+  FactorySet<EntityTypes> m_factories;
+};
+
+
+inline void GameEntity::Wake() { m_wake_step = m_world.getStep(); }
+
+inline bool GameEntity::isSleeping() const { return m_wake_step + 1 < m_world.getStep(); }
+
+
+/// выводит состав хранилищ юнитов мира (при определенном BATTLE_CITY_ENTITY_STATISTICS)
+inline void printEntityStatistics(const World& world, const std::string& label) {
+#ifdef BATTLE_CITY_ENTITY_STATISTICS
+  using namespace std;
+  cout << endl << label << endl;
+  cout << "Statistics : " << endl;
+  cout << "World::getRegistry().size() \t: " << world.getRegistry().size() << endl;
+  ForEachType(EntityTypes(), [&world](auto tag) {
+    using T = typename decltype(tag)::type;
+    cout << EntityName<T>::get() << " \t: " << world.getFactory<T>().getCurrentSet().size() << endl;
+  });
+  cout << endl;
+  ForEachType(EntityTypes(), [&world](auto tag) {
+    using T = typename decltype(tag)::type;
+    cout << "collection " << EntityName<T>::get() << " \t: "
+         << world.getFactory<T>().getCollection().size() << endl;
+  });
+#else
+  (void)world;
+  (void)label;
+#endif
+}
@@ -1,16 +1,38 @@
+#include <string>
+#include <cstdlib>
+#include <cstdint>
+
 #include "Game.h"
+#include "HeadlessGame.h"
 #include "SpriteManager.h"
 #include "GuiControl.h"
 #include "Units.h"
 #include "GameBattleCity.h"
 #include "Animating.h"
 
-void main(int argc, void** argv[]) {
+int main(int argc, char** argv) {
   // Program entry point.
+  // BattleCity --headless [map_file [ticks [seed [tick_rate [paths_file]]]]] - битва
+  // без окна, отчет о скорости шагов; пустой map_file ("") - первый уровень списка,
+  // tick_rate - шагов моделирования в секунду битвы (по умолчанию 60, как в Game)
+  if (argc > 1 && std::string(argv[1]) == "--headless") {
+    std::string map_file = argc > 2 ? argv[2] : "";
+    unsigned ticks = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 3600;
+    std::uint64_t seed = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : Random::kDefaultSeed;
+    double tick_rate = argc > 5 ? std::strtod(argv[5], nullptr) : 60;
+    if (!(tick_rate > 0)) tick_rate = 60;
+    std::string paths_file = argc > 6 ? argv[6] : "../resources/paths.cfg";
+    HeadlessGame game(paths_file);
+    sf::Time tick = sf::seconds(float(1 / tick_rate));
+    std::cout << game.Run(map_file, ticks, seed, tick) << std::endl;
+    return 0;
+  }
+
   Game game;
   while (!game.GetWindow()->IsDone()) {
     game.Update();
     game.Render();
     game.LateUpdate();
   }
+  return 0;
 }